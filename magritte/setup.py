@@ -330,6 +330,8 @@ def set_linedata_from_LAMDA_file (model, fileNames, config={}):
         raise ValueError('Number of provided LAMDA files != nlspecs')
     # Create lineProducingSpecies objects
     model.lines.lineProducingSpecies = vLineProducingSpecies([LineProducingSpecies() for _ in fileNames])
+    # Share the model parameters with the new species
+    model.set_parameters()
     # Convenient name
     species = model.chemistry.species
     # Add data for each LAMDA file
@@ -4,9 +4,11 @@
 #include "tools/types.hpp"
 #include "model/parameters/parameters.hpp"
 #include "io/cpp/io_cpp_text.hpp"
+#include "io/cpp/io_cpp_binary.hpp"
 #include "io/python/io_python.hpp"
 #include "model/model.hpp"
 #include "solver/solver.hpp"
+#include "ensemble/ensemble.hpp"
 
 #include "pybind11/pybind11.h"
 #include "pybind11/stl_bind.h"
@@ -52,16 +54,39 @@ PYBIND11_MODULE (core, module)
         .def (py::init<const string &>());
 
 
+    // IoBinary
+    py::class_<IoBinary, Io> (module, "IoBinary")
+        // attributes
+        .def_readonly ("io_file", &IoBinary::io_file)
+        // functions
+        .def ("flush",            &IoBinary::flush)
+        // constructor
+        .def (py::init<const string &>());
+
+
     #if (PYTHON_IO)
         // IoPython
         py::class_<IoPython, Io> (module, "IoPython")
             // attributes
             .def_readonly ("implementation", &IoPython::implementation)
             .def_readonly ("io_file",        &IoPython::io_file)
+            // functions
+            .def ("flush",                   &IoPython::flush)
+            .def ("close",                   &IoPython::close)
             // constructor
             .def (py::init<const string &, const string &>());
     #endif
 
+
+    #if (HDF5_IO)
+        // IoHdf5
+        py::class_<IoHdf5, Io> (module, "IoHdf5")
+            // attributes
+            .def_readonly ("io_file", &IoHdf5::io_file)
+            // constructor
+            .def (py::init<const string &>());
+    #endif
+
     // Solver
     py::class_<Solver> (module, "Solver")
         // attributes
@@ -82,11 +107,61 @@ PYBIND11_MODULE (core, module)
         // constructor
         .def (py::init<const Geometry&, const Size&>());
 
+    // Ensemble
+    py::class_<Ensemble> (module, "Ensemble")
+        // functions
+        .def ("get_n_variants",                            &Ensemble::get_n_variants)
+        .def ("variant",                                   &Ensemble::variant, py::return_value_policy::reference_internal)
+        .def ("compute_radiation_field_feautrier_order_2", &Ensemble::compute_radiation_field_feautrier_order_2)
+        .def ("compute_level_populations",                 &Ensemble::compute_level_populations)
+        // constructor
+        .def (py::init<const Model&, const Size&>());
+
+    // Quantities of which changes are tracked in a model
+    // (values are not exported, since they would shadow the classes)
+    py::enum_<Model::Quantity>(module, "Quantity")
+        .value("Geometry",          Model::Q_Geometry)
+        .value("Temperature",       Model::Q_Temperature)
+        .value("Turbulence",        Model::Q_Turbulence)
+        .value("LineData",          Model::Q_LineData)
+        .value("Boundary",          Model::Q_Boundary)
+        .value("InverseWidths",     Model::Q_InverseWidths)
+        .value("Frequencies",       Model::Q_Frequencies)
+        .value("RayLengths",        Model::Q_RayLengths)
+        .value("BoundaryCondition", Model::Q_BoundaryCondition)
+        .value("PointComponents",   Model::Q_PointComponents);
+
+
+    // Profiler
+    py::class_<Profiler> (module, "Profiler")
+        // functions
+        .def ("get_json",   &Profiler::get_json)
+        .def ("get_csv",    &Profiler::get_csv)
+        .def ("write_json", &Profiler::write_json)
+        .def ("write_csv",  &Profiler::write_csv)
+        .def ("clear",      &Profiler::clear)
+        // constructor
+        .def (py::init());
+
+
+    // WorkCounters
+    py::class_<WorkCounters> (module, "WorkCounters")
+        // attributes
+        .def_readonly ("totals",        &WorkCounters::totals)
+        .def_readonly ("histogram",     &WorkCounters::histogram)
+        // functions
+        .def ("get_totals",             &WorkCounters::get_totals)
+        .def ("get_histogram",          &WorkCounters::get_histogram)
+        .def ("clear",                  &WorkCounters::clear)
+        // constructor
+        .def (py::init());
+
+
     // Model
     py::class_<Model> (module, "Model")
         // attributes
         .def_readwrite ("parameters",     &Model::parameters)
-        .def_readwrite ("geometry",       &Model::geometry)
+        .def_property_readonly ("geometry", &Model::get_geometry, py::return_value_policy::reference_internal)
         .def_readwrite ("chemistry",      &Model::chemistry)
         .def_readwrite ("lines",          &Model::lines)
         .def_readwrite ("a",          &Model::a)
@@ -94,10 +169,15 @@ PYBIND11_MODULE (core, module)
         .def_readwrite ("c",          &Model::c)
         .def ("set",                  &Model::set)
         .def ("add",                  &Model::add)
+        .def ("set_parameters",       &Model::set_parameters)
         .def_readwrite ("thermodynamics", &Model::thermodynamics)
         .def_readwrite ("radiation",      &Model::radiation)
         .def_readonly  ("error_mean",     &Model::error_mean)
         .def_readonly  ("error_max",      &Model::error_max)
+        .def_readonly  ("n_formal_solutions",  &Model::n_formal_solutions)
+        .def_readonly  ("n_krylov_iterations", &Model::n_krylov_iterations)
+        .def_readonly  ("profiler",       &Model::profiler)
+        .def_readonly  ("counters",       &Model::counters)
         .def_readonly  ("images",         &Model::images)
         // io (void (Pet::*)(int))
         .def ("read",  (void (Model::*)(void))            &Model::read )
@@ -108,14 +188,30 @@ PYBIND11_MODULE (core, module)
         .def ("compute_spectral_discretisation", (int (Model::*)(void            )) &Model::compute_spectral_discretisation)
         .def ("compute_spectral_discretisation", (int (Model::*)(const Real width)) &Model::compute_spectral_discretisation)
         .def ("compute_spectral_discretisation", (int (Model::*)(const long double nu_min, const long double nu_max)) &Model::compute_spectral_discretisation)
+        .def ("compute_spectral_discretisation_merged",                             &Model::compute_spectral_discretisation_merged)
         .def ("compute_LTE_level_populations",                                      &Model::compute_LTE_level_populations)
         // .def ("compute_radiation_field",                                            &Model::compute_radiation_field)
         .def ("compute_radiation_field_feautrier_order_2",                          &Model::compute_radiation_field_feautrier_order_2)
         .def ("compute_radiation_field_shortchar_order_0",                          &Model::compute_radiation_field_shortchar_order_0)
+        .def ("compute_scattered_intensity",                                        &Model::compute_scattered_intensity)
         .def ("compute_Jeff",                                                       &Model::compute_Jeff)
         .def ("compute_level_populations_from_stateq",                              &Model::compute_level_populations_from_stateq)
         .def ("compute_level_populations",                                          &Model::compute_level_populations)
         .def ("compute_image",                                                      &Model::compute_image)
+        .def ("coarsen_grid",                                                       &Model::coarsen_grid)
+        .def ("prolongate_level_populations",                                       &Model::prolongate_level_populations)
+        .def ("compute_level_populations_multigrid",                                &Model::compute_level_populations_multigrid)
+        .def ("compute_level_populations_sobolev",                                  &Model::compute_level_populations_sobolev)
+        .def ("compute_level_populations_newton_krylov",                            &Model::compute_level_populations_newton_krylov)
+        .def ("set_temperature",                                                    &Model::set_temperature)
+        .def ("set_turbulence",                                                     &Model::set_turbulence)
+        .def ("set_velocity",                                                       &Model::set_velocity)
+        .def ("set_boundary_temperature",                                           &Model::set_boundary_temperature)
+        .def ("mark_changed",                                                       &Model::mark_changed)
+        .def ("is_stale",                                                           &Model::is_stale)
+        .def ("update",                                                             &Model::update)
+        .def ("place_memory_numa",                                                  &Model::place_memory_numa)
+        .def ("report_memory_placement",                                            &Model::report_memory_placement)
         .def ("set_eta_and_chi",                                                    &Model::set_eta_and_chi)
         .def ("set_boundary_condition",                                             &Model::set_boundary_condition)
         .def_readwrite ("eta",                &Model::eta)
@@ -128,8 +224,11 @@ PYBIND11_MODULE (core, module)
     // Parameters
     py::class_<Parameters> (module, "Parameters")
         // io
-        .def_readwrite ("n_off_diag",         &Parameters::n_off_diag)
-        .def_readwrite ("max_width_fraction", &Parameters::max_width_fraction)
+        .def_property ("n_off_diag",         &Parameters::get_n_off_diag,         &Parameters::set_n_off_diag        )
+        .def_property ("max_width_fraction", &Parameters::get_max_width_fraction, &Parameters::set_max_width_fraction)
+        .def_property ("max_solver_memory",  &Parameters::get_max_solver_memory,  &Parameters::set_max_solver_memory )
+        .def_property ("alo_drop_tolerance", &Parameters::get_alo_drop_tolerance, &Parameters::set_alo_drop_tolerance)
+        .def_property ("alo_max_elements",   &Parameters::get_alo_max_elements,   &Parameters::set_alo_max_elements  )
         // setters
         .def ("set_model_name",               &Parameters::set_model_name          )
         .def ("set_dimension",                &Parameters::set_dimension           )
@@ -186,6 +285,8 @@ PYBIND11_MODULE (core, module)
         .def ("read",               &Geometry::read)
         .def ("write",              &Geometry::write)
         // functions
+        .def ("coarsen",              &Geometry::coarsen)
+        .def ("set_coarsening_level", &Geometry::set_coarsening_level)
         // .def ("get_ray_lengths",     &Geometry::get_ray_lengths)
         // .def ("get_ray_lengths_gpu", &Geometry::get_ray_lengths_gpu)
         // constructor
@@ -197,11 +298,20 @@ PYBIND11_MODULE (core, module)
         // attributes
         .def_readwrite ("position",        &Points::position)
         .def_readwrite ("velocity",        &Points::velocity)
+        .def_readonly  ("x",               &Points::x)
+        .def_readonly  ("y",               &Points::y)
+        .def_readonly  ("z",               &Points::z)
+        .def_readonly  ("vx",              &Points::vx)
+        .def_readonly  ("vy",              &Points::vy)
+        .def_readonly  ("vz",              &Points::vz)
         .def_readwrite ("neighbors",       &Points::neighbors)
         .def_readwrite ("n_neighbors",     &Points::n_neighbors)
         .def_readwrite ("cum_n_neighbors", &Points::cum_n_neighbors)
+        .def_readwrite ("multiscale",      &Points::multiscale)
         // .def_readwrite ("nbs",             &Points::nbs)
         .def ("print",                     &Points::print)
+        .def ("set_coarsening_level",      &Points::set_coarsening_level)
+        .def ("set_components",            &Points::set_components)
         // io
         .def ("read",                      &Points::read)
         .def ("write",                     &Points::write)
@@ -209,6 +319,19 @@ PYBIND11_MODULE (core, module)
         .def (py::init<>());
 
 
+    // Multiscale
+    py::class_<Multiscale> (module, "Multiscale")
+        // attributes
+        .def_readonly ("mask",      &Multiscale::mask)
+        .def_readonly ("neighbors", &Multiscale::neighbors)
+        .def_readonly ("curr_lvl",  &Multiscale::curr_lvl)
+        // functions
+        .def ("get_n_levels",       &Multiscale::get_n_levels)
+        .def ("get_n_points",       &Multiscale::get_n_points)
+        // constructor
+        .def (py::init<>());
+
+
     // Rays
     py::class_<Rays> (module, "Rays")
         // attributes
@@ -340,6 +463,10 @@ PYBIND11_MODULE (core, module)
         .def_readwrite ("RT",               &LineProducingSpecies::RT)
         .def_readwrite ("LambdaStar",       &LineProducingSpecies::LambdaStar)
         .def_readwrite ("LambdaTest",       &LineProducingSpecies::LambdaTest)
+        .def_readonly  ("time_assembly",      &LineProducingSpecies::time_assembly)
+        .def_readonly  ("time_factorisation", &LineProducingSpecies::time_factorisation)
+        .def_readonly  ("time_solve",         &LineProducingSpecies::time_solve)
+        .def_readonly  ("time_convergence",   &LineProducingSpecies::time_convergence)
         // functions
         .def ("read",                       &LineProducingSpecies::read)
         .def ("write",                      &LineProducingSpecies::write)
@@ -356,10 +483,14 @@ PYBIND11_MODULE (core, module)
         // .def_readwrite ("size", &Lambda::size)
         .def_readwrite ("Lss",  &Lambda::Lss)
         .def_readwrite ("nrs",  &Lambda::nrs)
+        .def_readonly  ("n_dropped", &Lambda::n_dropped)
         // functions
         .def ("add_element",    &Lambda::add_element)
         .def ("linearize_data", &Lambda::linearize_data)
         .def ("MPI_gather",     &Lambda::MPI_gather)
+        .def ("prune",          (void (Lambda::*)(const Size)) &Lambda::prune)
+        .def ("get_n_kept",     &Lambda::get_n_kept)
+        .def ("get_n_dropped",  &Lambda::get_n_dropped)
         // constructor
         .def (py::init<>());
 
@@ -424,6 +555,7 @@ PYBIND11_MODULE (core, module)
     py::class_<Radiation> (module, "Radiation")
         // attributes
         .def_readwrite ("frequencies", &Radiation::frequencies)
+        .def_readwrite ("scattering",  &Radiation::scattering)
         // .def_readwrite ("u",           &Radiation::u)
         // .def_readwrite ("v",           &Radiation::v)
         .def_readwrite ("I_bdy",       &Radiation::I_bdy)
@@ -431,7 +563,13 @@ PYBIND11_MODULE (core, module)
         .def_readwrite ("u",           &Radiation::u)
         .def_readwrite ("v",           &Radiation::v)
         .def_readwrite ("J",           &Radiation::J)
+        .def_readwrite ("U",           &Radiation::U)
+        .def_readonly  ("out_of_core", &Radiation::out_of_core)
         // functions
+        .def ("calc_U",                &Radiation::calc_U)
+        .def ("set_out_of_core",       &Radiation::set_out_of_core)
+        .def ("get_u_slab",            &Radiation::get_u_slab)
+        .def ("get_v_slab",            &Radiation::get_v_slab)
         .def ("read",                  &Radiation::read)
         .def ("write",                 &Radiation::write)
         // constructor
@@ -441,10 +579,33 @@ PYBIND11_MODULE (core, module)
     // Frequencies
     py::class_<Frequencies> (module, "Frequencies")
         // attributes
-        .def_readwrite ("nu", &Frequencies::nu)
+        .def_readwrite         ("nu_centre",       &Frequencies::nu_centre)
+        .def_readwrite         ("nu_offset",       &Frequencies::nu_offset)
+        .def_readwrite         ("width_index",     &Frequencies::width_index)
+        .def_readwrite         ("width_factor",    &Frequencies::width_factor)
+        .def_readwrite         ("nfreqs_red",      &Frequencies::nfreqs_red)
+        .def_readwrite         ("merge_tolerance", &Frequencies::merge_tolerance)
+        .def_property_readonly ("nu",              &Frequencies::get_nu)
+        // functions
+        .def                   ("read",            &Frequencies::read)
+        .def                   ("write",           &Frequencies::write)
+        // constructor
+        .def (py::init());
+
+
+    // Scattering
+    py::class_<Scattering> (module, "Scattering")
+        // attributes
+        .def_readwrite ("opacity",               &Scattering::opacity)
+        .def_readwrite ("frequency_ref",         &Scattering::frequency_ref)
+        .def_readwrite ("opacity_index",         &Scattering::opacity_index)
+        .def_readwrite ("moments",               &Scattering::moments)
         // functions
-        .def ("read",         &Frequencies::read)
-        .def ("write",        &Frequencies::write)
+        .def ("set_isotropic",                   &Scattering::set_isotropic)
+        .def ("set_henyey_greenstein",           &Scattering::set_henyey_greenstein)
+        .def ("phase",                           &Scattering::phase)
+        .def ("read",                            &Scattering::read)
+        .def ("write",                           &Scattering::write)
         // constructor
         .def (py::init());
 
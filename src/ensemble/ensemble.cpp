@@ -0,0 +1,172 @@
+#include "ensemble.hpp"
+#include "solver/solver.hpp"
+
+
+///  Constructor for Ensemble
+///  (if the model keeps its radiation field out of core, every variant gets
+///  its own files, named after those of the model, with the variant number)
+///    @param[in] model      : model of which the variants are copies
+///    @param[in] n_variants : number of variants in the ensemble
+/////////////////////////////////////////////////////////////////////////////
+Ensemble :: Ensemble (const Model& model, const Size n_variants)
+    : variants (n_variants, model)
+{
+    if (model.radiation.out_of_core)
+    {
+        const string& u_file = model.radiation.u_on_disk.file_name;
+        const string  base   = u_file.substr (0, u_file.size() - 2);   // strip ".u"
+
+        for (Size v = 0; v < n_variants; v++)
+        {
+            variants[v].radiation.set_out_of_core (base + "_variant_" + std::to_string (v));
+        }
+    }
+}
+
+
+///  Getter for a variant of the model
+///    @param[in] v : index of the variant
+///    @return reference to the variant
+///////////////////////////////////////////
+Model& Ensemble :: variant (const Size v)
+{
+    if (v >= variants.size())
+    {
+        throw std::runtime_error ("Ensemble has no variant with this index.");
+    }
+
+    return variants[v];
+}
+
+
+///  Compute the radiation field for all variants, tracing each ray once
+////////////////////////////////////////////////////////////////////////
+int Ensemble :: compute_radiation_field_feautrier_order_2 ()
+{
+    cout << "Computing radiation field for " << variants.size() << " variants..." << endl;
+
+    if (variants.empty()) {return (0);}
+
+    for (const Model& model : variants)
+    {
+        if (   (model.parameters.storage != variants[0].parameters.storage)
+            || (model.shared_geometry    != variants[0].shared_geometry   ) )
+        {
+            throw std::runtime_error ("Ensemble variants should be copies of the same model.");
+        }
+    }
+
+    for (Model& model : variants) {model.update();}
+
+    Solver solver;
+    solver.setup <CoMoving>        (variants);
+    solver.solve_feautrier_order_2 (variants);
+
+    for (Model& model : variants) {model.n_formal_solutions++;}
+
+    return (0);
+}
+
+
+///  Compute the level populations for all variants (as in
+///  Model::compute_level_populations), sharing the ray tracing
+///    @param[in] use_Ng_acceleration : true if Ng acceleration is used
+///    @param[in] max_niterations     : maximum number of iterations
+///    @return number of iterations
+//////////////////////////////////////////////////////////////////////
+int Ensemble :: compute_level_populations (
+    const bool use_Ng_acceleration,
+    const long max_niterations     )
+{
+    // Check spectral discretisation setting
+    for (const Model& model : variants)
+    {
+        if (model.spectralDiscretisation != Model::SD_Lines)
+        {
+            throw std::runtime_error ("Spectral discretisation was not set for Lines!");
+        }
+    }
+
+    // Initialize the number of iterations
+    int iteration        = 0;
+    int iteration_normal = 0;
+
+    // Initialize errors
+    for (Model& model : variants)
+    {
+        model.error_mean.clear ();
+        model.error_max .clear ();
+    }
+
+    // Initialize some_not_converged
+    bool some_not_converged = true;
+
+    // Iterate as long as some levels (of some variant) are not converged
+    while (some_not_converged && (iteration < max_niterations))
+    {
+        iteration++;
+
+        cout << "Starting iteration " << iteration << endl;
+
+        // Start assuming convergence
+        some_not_converged = false;
+
+        if (use_Ng_acceleration && (iteration_normal == 4))
+        {
+            for (Model& model : variants)
+            {
+                model.lines.iteration_using_Ng_acceleration (model.parameters.pop_prec());
+            }
+
+            iteration_normal = 0;
+        }
+        else
+        {
+            compute_radiation_field_feautrier_order_2 ();
+
+            for (Model& model : variants)
+            {
+                model.compute_Jeff ();
+
+                model.lines.iteration_using_statistical_equilibrium (
+                    model.chemistry.species.abundance,
+                    model.thermodynamics.temperature.gas,
+                    model.parameters.pop_prec(),
+                    model.geometry.points.multiscale.get_mask()     );
+            }
+
+            iteration_normal++;
+        }
+
+        for (Size v = 0; v < variants.size(); v++)
+        {
+            Model& model = variants[v];
+
+            // Fill in the points that are not in the current (coarse) grid
+            if (model.geometry.points.multiscale.curr_lvl > 0)
+            {
+                model.prolongate_level_populations (model.geometry.points.multiscale.curr_lvl);
+            }
+
+            for (Size l = 0; l < model.parameters.nlspecs(); l++)
+            {
+                const LineProducingSpecies& lspec = model.lines.lineProducingSpecies[l];
+
+                model.error_mean.push_back (lspec.relative_change_mean);
+                model.error_max .push_back (lspec.relative_change_max);
+
+                if (lspec.fraction_not_converged > 0.005)
+                {
+                    some_not_converged = true;
+                }
+
+                cout << "Variant " << v << ": already " << 100 * (1.0 - lspec.fraction_not_converged) << " % converged!" << endl;
+            }
+        }
+    } // end of while loop of iterations
+
+    // Print convergence stats
+    cout << "Converged after " << iteration << " iterations" << endl;
+
+    return iteration;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+
+#include "model/model.hpp"
+#include "tools/types.hpp"
+
+
+///  Ensemble: variants of a model that share the same geometry, e.g. for
+///  parameter sweeps in abundances, temperatures or line data. The rays
+///  are traced only once for all variants. Since the variants are copies
+///  of the same model, they share its geometry (which is not copied) and
+///  its parameters, hence only the other physical quantities should be
+///  changed (not their sizes).
+/////////////////////////////////////////////////////////////////////////
+struct Ensemble
+{
+    vector<Model> variants;   ///< model variants (sharing their geometry)
+
+    Ensemble () {};
+    Ensemble (const Model& model, const Size n_variants);
+
+    Size   get_n_variants () const {return variants.size();};
+    Model& variant        (const Size v);
+
+    int compute_radiation_field_feautrier_order_2 ();
+    int compute_level_populations                 (
+        const bool use_Ng_acceleration,
+        const long max_niterations     );
+};
@@ -0,0 +1,909 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+
+#include "io_cpp_binary.hpp"
+
+
+const char     binary_magic[8] = {'M','A','G','R','I','T','T','E'};
+const uint64_t binary_version  = 1;
+const uint64_t binary_align    = 64;   ///< alignment of the data blocks (bytes)
+
+
+///  Types of the elements in the data blocks (stored in native representation)
+///////////////////////////////////////////////////////////////////////////////
+enum BinaryType : uint32_t {Binary_Long, Binary_Size, Binary_Size_t, Binary_Double, Binary_Real, Binary_String};
+
+template <class type> struct BinaryTypeOf {};
+template <> struct BinaryTypeOf <long>          {static const uint32_t value = Binary_Long;  };
+template <> struct BinaryTypeOf <unsigned int>  {static const uint32_t value = Binary_Size;  };
+template <> struct BinaryTypeOf <unsigned long> {static const uint32_t value = Binary_Size_t;};
+template <> struct BinaryTypeOf <double>        {static const uint32_t value = Binary_Double;};
+template <> struct BinaryTypeOf <long double>   {static const uint32_t value = Binary_Real;  };
+
+
+///  Header at the start of the binary file
+///////////////////////////////////////////
+struct BinaryHeader
+{
+    char     magic[8];
+    uint64_t version;
+    uint64_t n_entries;
+    uint64_t table_offset;
+    uint64_t sizeof_real;
+    uint64_t reserved[3];
+};
+
+
+///  Getter for a single element of a data block, converted to long double
+///    @param[in] src  : start of the data block
+///    @param[in] type : type of the elements in the block
+///    @param[in] i    : index of the element
+///////////////////////////////////////////////////////////////////////////
+inline long double get_element (const char* src, const uint32_t type, const size_t i)
+{
+    switch (type)
+    {
+        case Binary_Long   : {long          v; std::memcpy (&v, src + i*sizeof(v), sizeof(v)); return v;}
+        case Binary_Size   : {unsigned int  v; std::memcpy (&v, src + i*sizeof(v), sizeof(v)); return v;}
+        case Binary_Size_t : {unsigned long v; std::memcpy (&v, src + i*sizeof(v), sizeof(v)); return v;}
+        case Binary_Double : {double        v; std::memcpy (&v, src + i*sizeof(v), sizeof(v)); return v;}
+        case Binary_Real   : {long double   v; std::memcpy (&v, src + i*sizeof(v), sizeof(v)); return v;}
+        default            : {throw std::runtime_error ("Invalid element type in binary file.");}
+    }
+}
+
+
+///  Constructor for IoBinary, maps the file (if it exists)
+///    @param[in] io_file : file to read from and write to
+///////////////////////////////////////////////////////////
+IoBinary :: IoBinary (const string &io_file) : Io (io_file)
+{
+    map_file ();
+}
+
+
+///  Destructor for IoBinary, writes pending data to the file
+/////////////////////////////////////////////////////////////
+IoBinary :: ~IoBinary ()
+{
+    flush ();
+}
+
+
+///  Map the file into memory and read its offset table
+///////////////////////////////////////////////////////
+void IoBinary :: map_file () const
+{
+    table.clear();
+
+    if (!mapped.open (io_file)) {return;}
+
+    BinaryHeader header;
+
+    if (mapped.size < sizeof(header))
+    {
+        throw std::runtime_error ("Not a Magritte binary file: " + io_file);
+    }
+
+    std::memcpy (&header, mapped.data, sizeof(header));
+
+    if (std::memcmp (header.magic, binary_magic, sizeof(binary_magic)) != 0)
+    {
+        throw std::runtime_error ("Not a Magritte binary file: " + io_file);
+    }
+
+    if (header.version != binary_version)
+    {
+        throw std::runtime_error ("Unsupported version of Magritte binary file: " + io_file);
+    }
+
+    if (header.sizeof_real != sizeof(Real))
+    {
+        throw std::runtime_error ("Binary file was written with a different Real type: " + io_file);
+    }
+
+    const char* ptr = mapped.data + header.table_offset;
+
+    for (uint64_t e = 0; e < header.n_entries; e++)
+    {
+        uint32_t length;
+        std::memcpy (&length, ptr, sizeof(length));   ptr += sizeof(length);
+
+        const string name (ptr, length);               ptr += length;
+
+        Entry entry;
+        std::memcpy (&entry.type,   ptr, sizeof(entry.type  ));   ptr += sizeof(entry.type  );
+        std::memcpy (&entry.rank,   ptr, sizeof(entry.rank  ));   ptr += sizeof(entry.rank  );
+        std::memcpy ( entry.dims,   ptr, sizeof(entry.dims  ));   ptr += sizeof(entry.dims  );
+        std::memcpy (&entry.offset, ptr, sizeof(entry.offset));   ptr += sizeof(entry.offset);
+        std::memcpy (&entry.nbytes, ptr, sizeof(entry.nbytes));   ptr += sizeof(entry.nbytes);
+
+        table[name] = entry;
+    }
+}
+
+
+///  Write all data (existing and pending) to the file
+///  The file is written as a whole to a temporary file, which then replaces
+///  the original one, such that the current mapping remains valid.
+///    @return 0 on success, -1 if the file could not be written
+////////////////////////////////////////////////////////////////////////////
+int IoBinary :: flush () const
+{
+    if (pending.empty()) {return (0);}
+
+    // Collect all entries, pending writes replace existing ones
+    std::map<string, const Entry*> entries;
+
+    for (const auto &it : table  ) {entries[it.first] = &it.second;}
+    for (const auto &it : pending) {entries[it.first] = &it.second;}
+
+    const string tmp_file = io_file + ".tmp";
+
+    std::ofstream file (tmp_file, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {return (-1);}
+
+    BinaryHeader header;
+    std::memset (&header, 0, sizeof(header));
+    std::memcpy (header.magic, binary_magic, sizeof(binary_magic));
+
+    header.version     = binary_version;
+    header.n_entries   = entries.size();
+    header.sizeof_real = sizeof(Real);
+
+    file.write (reinterpret_cast<const char*> (&header), sizeof(header));
+
+    const char zeros[binary_align] = {0};
+
+    uint64_t position = sizeof(header);
+
+    std::map<string, uint64_t> offsets;
+
+    for (const auto &it : entries)
+    {
+        const Entry& entry = *it.second;
+
+        // Pad to the next aligned position
+        const uint64_t padding = (binary_align - position % binary_align) % binary_align;
+
+        file.write (zeros, padding);
+        position += padding;
+
+        offsets[it.first] = position;
+
+        file.write (data (entry), entry.nbytes);
+        position += entry.nbytes;
+    }
+
+    header.table_offset = position;
+
+    for (const auto &it : entries)
+    {
+        const Entry&   entry  = *it.second;
+        const uint32_t length = it.first.size();
+
+        file.write (reinterpret_cast<const char*> (&length),             sizeof(length)      );
+        file.write (it.first.data(),                                     length              );
+        file.write (reinterpret_cast<const char*> (&entry.type),         sizeof(entry.type)  );
+        file.write (reinterpret_cast<const char*> (&entry.rank),         sizeof(entry.rank)  );
+        file.write (reinterpret_cast<const char*> ( entry.dims),         sizeof(entry.dims)  );
+        file.write (reinterpret_cast<const char*> (&offsets[it.first]),  sizeof(uint64_t)    );
+        file.write (reinterpret_cast<const char*> (&entry.nbytes),       sizeof(entry.nbytes));
+    }
+
+    // Rewrite the header, now with the offset of the table
+    file.seekp (0);
+    file.write (reinterpret_cast<const char*> (&header), sizeof(header));
+    file.close ();
+
+    if (!file.good()) {return (-1);}
+
+    if (std::rename (tmp_file.c_str(), io_file.c_str()) != 0) {return (-1);}
+
+    pending.clear();
+
+    map_file();
+
+    return (0);
+}
+
+
+///  Find the entry with the given name (pending writes first)
+///    @param[in] fname : name of the entry
+///    @return pointer to the entry, nullptr if it does not exist
+//////////////////////////////////////////////////////////////////
+const IoBinary::Entry* IoBinary :: find (const string fname) const
+{
+    const auto it_p = pending.find (fname);
+    if (it_p != pending.end()) {return &(it_p->second);}
+
+    const auto it_t = table.find (fname);
+    if (it_t != table.end()) {return &(it_t->second);}
+
+    return nullptr;
+}
+
+
+///  Getter for the data of an entry
+///    @param[in] entry : entry in the table or a pending write
+///    @return pointer to the start of the data
+////////////////////////////////////////////////////////////////
+const char* IoBinary :: data (const Entry& entry) const
+{
+    if (entry.bytes.size() > 0) {return entry.bytes.data();       }
+    else                        {return mapped.data + entry.offset;}
+}
+
+
+///  Reader for numeric values, copied (or converted if the type differs)
+///  straight from the mapped memory
+///    @param[in]  fname  : name of the entry
+///    @param[out] values : values to be read
+///    @param[out] nrows  : number of rows
+///    @param[out] ncols  : number of columns (1 for lists and scalars)
+/////////////////////////////////////////////////////////////////////////
+template <class type>
+int IoBinary :: read_values (const string fname, vector<type> &values, Size &nrows, Size &ncols) const
+{
+    const Entry* entry = find (fname);
+
+    if ((entry == nullptr) || (entry->type == Binary_String)) {return (-1);}
+
+    nrows = entry->dims[0];
+    ncols = (entry->rank == 2) ? entry->dims[1] : 1;
+
+    const size_t n   = nrows * ncols;
+    const char*  src = data (*entry);
+
+    values.resize (n);
+
+    if (entry->type == BinaryTypeOf<type>::value)
+    {
+        std::memcpy (values.data(), src, n*sizeof(type));
+    }
+    else
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            values[i] = (type) get_element (src, entry->type, i);
+        }
+    }
+
+    return (0);
+}
+
+
+///  Writer for numeric values (buffered until flush)
+///    @param[in] fname  : name of the entry
+///    @param[in] values : values to be written
+///    @param[in] rank   : 0 (scalar), 1 (list) or 2 (array)
+///    @param[in] ncols  : number of columns (for rank 2)
+///////////////////////////////////////////////////////////
+template <class type>
+int IoBinary :: write_values (const string fname, const vector<type> &values, const Size rank, const Size ncols) const
+{
+    Entry entry;
+
+    entry.type    = BinaryTypeOf<type>::value;
+    entry.rank    = rank;
+    entry.dims[0] = (rank == 2) ? values.size() / ncols : values.size();
+    entry.dims[1] = (rank == 2) ? ncols                 : 1;
+    entry.nbytes  = values.size() * sizeof(type);
+
+    entry.bytes.resize (entry.nbytes);
+    std::memcpy (entry.bytes.data(), values.data(), entry.nbytes);
+
+    pending[fname] = std::move (entry);
+
+    return (0);
+}
+
+
+///  Reader for a 2D array into a vector of vectors
+///    @param[in]  fname : name of the entry
+///    @param[out] array : array to be read
+/////////////////////////////////////////////////////
+template <class type>
+int IoBinary :: read_2D (const string fname, vector<vector<type>> &array) const
+{
+    vector<type> buffer;
+    Size nrows, ncols;
+
+    const int err = read_values (fname, buffer, nrows, ncols);
+
+    if (err == 0)
+    {
+        array.resize (nrows);
+
+        for (Size i = 0; i < nrows; i++)
+        {
+            array[i].assign (buffer.begin() + i*ncols, buffer.begin() + (i+1)*ncols);
+        }
+    }
+
+    return err;
+}
+
+
+///  Writer for a vector of vectors into a 2D array
+///    @param[in] fname : name of the entry
+///    @param[in] array : array to be written (all rows of equal length)
+////////////////////////////////////////////////////////////////////////
+template <class type>
+int IoBinary :: write_2D (const string fname, const vector<vector<type>> &array) const
+{
+    if (array.size() == 0) {return (0);}
+
+    const Size ncols = array[0].size();
+
+    vector<type> buffer;
+    buffer.reserve (array.size()*ncols);
+
+    for (const vector<type> &row : array)
+    {
+        if (row.size() != ncols) {return (-1);}
+
+        buffer.insert (buffer.end(), row.begin(), row.end());
+    }
+
+    return write_values (fname, buffer, 2, ncols);
+}
+
+
+///  Reader for the length of a list or array, or the number of objects
+///  in a group of which the name contains the last part of the given name
+///    @param[in]  file_name : name of the entry
+///    @param[out] length    : length to be read
+///////////////////////////////////////////////////////////////////////////
+int IoBinary :: read_length (const string file_name, Size &length) const
+{
+    const Entry* entry = find (file_name);
+
+    if (entry != nullptr)
+    {
+        length = entry->dims[0];
+        return (0);
+    }
+
+    // Count the number of (distinct) objects with a similar name
+    const size_t pos    = file_name.rfind ('/');
+    const string object = (pos == string::npos) ? file_name : file_name.substr (pos+1);
+    const string group  = (pos == string::npos) ? ""        : file_name.substr (0, pos+1);
+
+    std::set<string> children;
+
+    auto add_child = [&] (const string &name)
+    {
+        if (name.compare (0, group.size(), group) != 0) {return;}
+
+        const string child = name.substr (group.size(), name.find ('/', group.size()) - group.size());
+
+        if ((child.size() > 0) && (child[0] != '.') && (child.find (object) != string::npos))
+        {
+            children.insert (child);
+        }
+    };
+
+    for (const auto &it : table  ) {add_child (it.first);}
+    for (const auto &it : pending) {add_child (it.first);}
+
+    length = children.size();
+
+    return (0);
+}
+
+
+///  Getter for the length of a list or array
+///    @param[in]  file_name : name of the entry
+///    @returns length of the entry
+///////////////////////////////////////////////
+Size IoBinary :: get_length (const string file_name) const
+{
+    Size length;
+    read_length (file_name, length);
+    return length;
+}
+
+
+///  Reader for the number of columns (width) of an array
+///  or the number of objects with a similar name
+///    @param[in]  file_name : name of the entry
+///    @param[out] width     : width to be read
+/////////////////////////////////////////////////////////
+int IoBinary :: read_width (const string file_name, Size &width) const
+{
+    const Entry* entry = find (file_name);
+
+    if (entry != nullptr)
+    {
+        width = entry->dims[1];
+        return (entry->rank == 2) ? 0 : -1;
+    }
+
+    return read_length (file_name, width);
+}
+
+
+///  Getter for the number of columns (width) of an array
+///  or the number of objects with a similar name
+///    @param[in]  file_name : name of the entry
+///    @returns width of the entry
+/////////////////////////////////////////////////////////
+Size IoBinary :: get_width (const string file_name) const
+{
+    Size width;
+    read_width (file_name, width);
+    return width;
+}
+
+
+///  Reader for a single (long integer) number
+///    @param[in]  file_name : name of the entry
+///    @param[out] number    : number to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_number (const string file_name, long &number) const
+{
+    Long1 buffer;
+    Size  nrows, ncols;
+    const int err = read_values (file_name, buffer, nrows, ncols);
+    if (err == 0) {number = buffer[0];}
+    return err;
+}
+
+
+///  Writer for a single (long integer) number
+///    @param[in] file_name : name of the entry
+///    @param[in] number    : number to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_number (const string file_name, const long &number) const
+{
+    return write_values (file_name, Long1 (1, number), 0, 1);
+}
+
+
+///  Reader for a single (Size) number
+///    @param[in]  file_name : name of the entry
+///    @param[out] number    : number to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_number (const string file_name, Size &number) const
+{
+    Size1 buffer;
+    Size  nrows, ncols;
+    const int err = read_values (file_name, buffer, nrows, ncols);
+    if (err == 0) {number = buffer[0];}
+    return err;
+}
+
+
+///  Writer for a single (Size) number
+///    @param[in] file_name : name of the entry
+///    @param[in] number    : number to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_number (const string file_name, const Size &number) const
+{
+    return write_values (file_name, Size1 (1, number), 0, 1);
+}
+
+
+///  Reader for a single (Real) number
+///    @param[in]  file_name : name of the entry
+///    @param[out] number    : number to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_number (const string file_name, Real &number) const
+{
+    Real1 buffer;
+    Size  nrows, ncols;
+    const int err = read_values (file_name, buffer, nrows, ncols);
+    if (err == 0) {number = buffer[0];}
+    return err;
+}
+
+
+///  Writer for a single (Real) number
+///    @param[in] file_name : name of the entry
+///    @param[in] number    : number to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_number (const string file_name, const Real &number) const
+{
+    return write_values (file_name, Real1 (1, number), 0, 1);
+}
+
+
+///  Reader for a single string
+///    @param[in]  file_name : name of the entry
+///    @param[out] word      : string to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_word (const string file_name, string &word) const
+{
+    String1 list;
+    const int err = read_list (file_name, list);
+    if ((err == 0) && (list.size() > 0)) {word = list[0];}
+    return err;
+}
+
+
+///  Writer for a single string
+///    @param[in] file_name : name of the entry
+///    @param[in] word      : string to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_word (const string file_name, const string &word) const
+{
+    return write_list (file_name, String1 (1, word));
+}
+
+
+///  Reader for a single boolean
+///    @param[in]  file_name : name of the entry
+///    @param[out] value     : value to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_bool (const string file_name, bool &value) const
+{
+    // Treat booleans as text in io
+    string word;
+
+    int err = read_word (file_name, word);
+
+    if      (word.compare("true" ) == 0) {value = true; }
+    else if (word.compare("false") == 0) {value = false;}
+    else                                 {  err = -1;   }
+
+    return err;
+}
+
+
+///  Writer for a single boolean
+///    @param[in] file_name : name of the entry
+///    @param[in] value     : value to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_bool (const string file_name, const bool &value) const
+{
+    // Treat booleans as text in io
+    string word = "false";
+
+    if (value) {word = "true";}
+
+    return write_word (file_name, word);
+}
+
+
+///  Reader for a list of long integers
+///    @param[in]  file_name : name of the entry
+///    @param[out] list      : list to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_list (const string file_name, Long1 &list) const
+{
+    Size nrows, ncols;
+    return read_values (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of long integers
+///    @param[in] file_name : name of the entry
+///    @param[in] list      : list to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_list (const string file_name, const Long1 &list) const
+{
+    return write_values (file_name, list, 1, 1);
+}
+
+
+///  Reader for a list of doubles
+///    @param[in]  file_name : name of the entry
+///    @param[out] list      : list to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_list (const string file_name, Double1 &list) const
+{
+    Size nrows, ncols;
+    return read_values (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of doubles
+///    @param[in] file_name : name of the entry
+///    @param[in] list      : list to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_list (const string file_name, const Double1 &list) const
+{
+    return write_values (file_name, list, 1, 1);
+}
+
+
+///  Reader for a list of size_t's
+///    @param[in]  file_name : name of the entry
+///    @param[out] list      : list to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_list (const string file_name, Size_t1 &list) const
+{
+    Size nrows, ncols;
+    return read_values (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of size_t's
+///    @param[in] file_name : name of the entry
+///    @param[in] list      : list to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_list (const string file_name, const Size_t1 &list) const
+{
+    return write_values (file_name, list, 1, 1);
+}
+
+
+///  Reader for a list of Reals
+///    @param[in]  file_name : name of the entry
+///    @param[out] list      : list to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_list (const string file_name, Real1 &list) const
+{
+    Size nrows, ncols;
+    return read_values (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of Reals
+///    @param[in] file_name : name of the entry
+///    @param[in] list      : list to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_list (const string file_name, const Real1 &list) const
+{
+    return write_values (file_name, list, 1, 1);
+}
+
+
+///  Reader for a list of Sizes
+///    @param[in]  file_name : name of the entry
+///    @param[out] list      : list to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_list (const string file_name, Size1 &list) const
+{
+    Size nrows, ncols;
+    return read_values (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of Sizes
+///    @param[in] file_name : name of the entry
+///    @param[in] list      : list to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_list (const string file_name, const Size1 &list) const
+{
+    return write_values (file_name, list, 1, 1);
+}
+
+
+///  Reader for a list of strings (stored as consecutive null terminated strings)
+///    @param[in]  file_name : name of the entry
+///    @param[out] list      : list to be read
+/////////////////////////////////////////////////////////////////////////////////
+int IoBinary :: read_list (const string file_name, String1 &list) const
+{
+    const Entry* entry = find (file_name);
+
+    if ((entry == nullptr) || (entry->type != Binary_String)) {return (-1);}
+
+    const char* ptr = data (*entry);
+
+    list.resize (entry->dims[0]);
+
+    for (Size i = 0; i < entry->dims[0]; i++)
+    {
+        list[i] = string (ptr);
+        ptr    += list[i].size() + 1;
+    }
+
+    return (0);
+}
+
+
+///  Writer for a list of strings (stored as consecutive null terminated strings)
+///    @param[in] file_name : name of the entry
+///    @param[in] list      : list to be written
+/////////////////////////////////////////////////////////////////////////////////
+int IoBinary :: write_list (const string file_name, const String1 &list) const
+{
+    Entry entry;
+
+    entry.type    = Binary_String;
+    entry.rank    = 1;
+    entry.dims[0] = list.size();
+    entry.dims[1] = 1;
+
+    for (const string &word : list)
+    {
+        entry.bytes.insert (entry.bytes.end(), word.begin(), word.end());
+        entry.bytes.push_back ('\0');
+    }
+
+    entry.nbytes = entry.bytes.size();
+
+    pending[file_name] = std::move (entry);
+
+    return (0);
+}
+
+
+///  Reader for an array of long integers
+///    @param[in]  file_name : name of the entry
+///    @param[out] array     : array to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_array (const string file_name, Long2 &array) const
+{
+    return read_2D (file_name, array);
+}
+
+
+///  Writer for an array of long integers
+///    @param[in] file_name : name of the entry
+///    @param[in] array     : array to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_array (const string file_name, const Long2 &array) const
+{
+    return write_2D (file_name, array);
+}
+
+
+///  Reader for an array of doubles
+///    @param[in]  file_name : name of the entry
+///    @param[out] array     : array to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_array (const string file_name, Double2 &array) const
+{
+    return read_2D (file_name, array);
+}
+
+
+///  Writer for an array of doubles
+///    @param[in] file_name : name of the entry
+///    @param[in] array     : array to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_array (const string file_name, const Double2 &array) const
+{
+    return write_2D (file_name, array);
+}
+
+
+///  Reader for an array of Reals
+///    @param[in]  file_name : name of the entry
+///    @param[out] array     : array to be read
+//////////////////////////////////////////////////
+int IoBinary :: read_array (const string file_name, Real2 &array) const
+{
+    return read_2D (file_name, array);
+}
+
+
+///  Writer for an array of Reals
+///    @param[in] file_name : name of the entry
+///    @param[in] array     : array to be written
+/////////////////////////////////////////////////
+int IoBinary :: write_array (const string file_name, const Real2 &array) const
+{
+    return write_2D (file_name, array);
+}
+
+
+///  Reader for a list of 3-vectors, stored as an (N x 3) array of doubles
+///    @param[in]  file_name : name of the entry
+///    @param[out] v         : vector of 3-vectors to be read
+//////////////////////////////////////////////////////////////////////////
+int IoBinary :: read_array (const string file_name, Vector<Vector3D> &v) const
+{
+    Double1 buffer;
+    Size    nrows, ncols;
+
+    int err = read_values (file_name, buffer, nrows, ncols);
+
+    if ((err == 0) && (ncols != 3)) {err = -1;}
+
+    if (err == 0)
+    {
+        v.vec.resize (nrows);
+
+        for (Size p = 0; p < nrows; p++)
+        {
+            v.vec[p] = Vector3D (buffer[3*p], buffer[3*p+1], buffer[3*p+2]);
+        }
+
+        v.set_dat ();
+    }
+
+    return err;
+}
+
+
+///  Writer for a list of 3-vectors, stored as an (N x 3) array of doubles
+///    @param[in] file_name : name of the entry
+///    @param[in] v         : vector of 3-vectors to be written
+//////////////////////////////////////////////////////////////////////////
+int IoBinary :: write_array (const string file_name, const Vector<Vector3D> &v) const
+{
+    Double1 buffer (3*v.vec.size());
+
+    for (Size p = 0; p < v.vec.size(); p++)
+    {
+        buffer[3*p  ] = v.vec[p].x();
+        buffer[3*p+1] = v.vec[p].y();
+        buffer[3*p+2] = v.vec[p].z();
+    }
+
+    return write_values (file_name, buffer, 2, 3);
+}
+
+
+///  Reader for a list of 3-vectors of doubles
+///    @param[in]  file_name : name of the entry
+///    @param[out] x         : x component of the vector to be read
+///    @param[out] y         : y component of the vector to be read
+///    @param[out] z         : z component of the vector to be read
+///////////////////////////////////////////////////////////////////
+int IoBinary :: read_3_vector (
+        const string   file_name,
+              Double1 &x,
+              Double1 &y,
+              Double1 &z         ) const
+{
+    const Size length = x.size();
+
+    // Check if all 3 vectors are the same size
+    if (   (length != y.size())
+        || (length != z.size()) )
+    {
+        return (-1);
+    }
+
+    Double1 buffer;
+    Size    nrows, ncols;
+
+    int err = read_values (file_name, buffer, nrows, ncols);
+
+    if ((err == 0) && ((nrows != length) || (ncols != 3))) {err = -1;}
+
+    if (err == 0)
+    {
+        for (Size p = 0; p < length; p++)
+        {
+            x[p] = buffer[3*p  ];
+            y[p] = buffer[3*p+1];
+            z[p] = buffer[3*p+2];
+        }
+    }
+
+    return err;
+}
+
+
+///  Writer for a list of 3-vectors of doubles
+///    @param[in] file_name : name of the entry
+///    @param[in] x         : x component of the vector to be written
+///    @param[in] y         : y component of the vector to be written
+///    @param[in] z         : z component of the vector to be written
+/////////////////////////////////////////////////////////////////////
+int IoBinary :: write_3_vector (
+        const string   file_name,
+        const Double1 &x,
+        const Double1 &y,
+        const Double1 &z         ) const
+{
+    const Size length = x.size();
+
+    // Check if all 3 vectors are the same size
+    if (   (length != y.size())
+        || (length != z.size()) )
+    {
+        return (-1);
+    }
+
+    Double1 buffer (3*length);
+
+    for (Size p = 0; p < length; p++)
+    {
+        buffer[3*p  ] = x[p];
+        buffer[3*p+1] = y[p];
+        buffer[3*p+2] = z[p];
+    }
+
+    return write_values (file_name, buffer, 2, 3);
+}
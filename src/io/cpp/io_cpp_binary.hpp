@@ -0,0 +1,122 @@
+#pragma once
+
+
+#include <map>
+#include <unordered_map>
+
+#include "io/io.hpp"
+#include "io/cpp/mapped_file.hpp"
+#include "tools/types.hpp"
+
+
+///  IoBinary: io specified by a flat binary file that is memory mapped
+///  The file consists of a header, 64 byte aligned data blocks in native
+///  (in-memory) representation, and an offset table describing the blocks.
+///  Reading an array is a single copy from the page cache into its final
+///  storage. Writes are buffered and written to disk by flush (or when the
+///  object is destroyed), replacing the file as a whole.
+///////////////////////////////////////////////////////////////////////////
+
+struct IoBinary : public Io
+{
+    public:
+        // Constructor and destructor
+        IoBinary (const string &io_file);
+       ~IoBinary ();
+
+        // The file mapping can not be shared between copies
+        IoBinary (const IoBinary&) = delete;
+        IoBinary& operator= (const IoBinary&) = delete;
+
+        int flush () const;
+
+        int  read_length   (const string fname,       Size    &length) const override;
+        Size  get_length   (const string fname                       ) const override;
+
+        int  read_width    (const string fname,       Size    &width ) const override;
+        Size  get_width    (const string fname                       ) const override;
+
+        int  read_number   (const string fname,       long    &number) const override;
+        int write_number   (const string fname, const long    &number) const override;
+
+        int  read_number   (const string fname,       Size    &number) const override;
+        int write_number   (const string fname, const Size    &number) const override;
+
+        int  read_number   (const string fname,       Real    &number) const override;
+        int write_number   (const string fname, const Real    &number) const override;
+
+        int  read_word     (const string fname,       string  &word  ) const override;
+        int write_word     (const string fname, const string  &word  ) const override;
+
+        int  read_bool     (const string fname,       bool    &value ) const override;
+        int write_bool     (const string fname, const bool    &value ) const override;
+
+        int  read_list     (const string fname,       Long1   &list  ) const override;
+        int write_list     (const string fname, const Long1   &list  ) const override;
+
+        int  read_list     (const string fname,       Double1 &list  ) const override;
+        int write_list     (const string fname, const Double1 &list  ) const override;
+
+        int  read_list     (const string fname,       Size_t1 &list  ) const override;
+        int write_list     (const string fname, const Size_t1 &list  ) const override;
+
+        int  read_list     (const string fname,       Real1   &list  ) const override;
+        int write_list     (const string fname, const Real1   &list  ) const override;
+
+        int  read_list     (const string fname,       Size1   &list  ) const override;
+        int write_list     (const string fname, const Size1   &list  ) const override;
+
+        int  read_list     (const string fname,       String1 &list  ) const override;
+        int write_list     (const string fname, const String1 &list  ) const override;
+
+        int  read_array    (const string fname,       Long2   &array ) const override;
+        int write_array    (const string fname, const Long2   &array ) const override;
+
+        int  read_array    (const string fname,       Double2 &array ) const override;
+        int write_array    (const string fname, const Double2 &array ) const override;
+
+        int  read_array    (const string fname,       Real2   &array ) const override;
+        int write_array    (const string fname, const Real2   &array ) const override;
+
+        int  read_array    (const string fname,       Vector<Vector3D> &v) const override;
+        int write_array    (const string fname, const Vector<Vector3D> &v) const override;
+
+        int  read_3_vector (const string fname,       Double1 &x,
+                                                      Double1 &y,
+                                                      Double1 &z     ) const override;
+        int write_3_vector (const string fname, const Double1 &x,
+                                                const Double1 &y,
+                                                const Double1 &z     ) const override;
+
+
+    private:
+        ///  Description of a data block in the file (or of a pending write)
+        struct Entry
+        {
+            uint32_t     type   = 0;       ///< type of the elements
+            uint32_t     rank   = 0;       ///< 0 (scalar), 1 (list) or 2 (array)
+            uint64_t     dims[2] = {0, 0}; ///< number of rows and columns
+            uint64_t     offset = 0;       ///< offset of the data in the file
+            uint64_t     nbytes = 0;       ///< size of the data (bytes)
+            vector<char> bytes;            ///< data of a pending write
+        };
+
+        mutable MappedFile                        mapped;    ///< mapping of the file
+        mutable std::unordered_map<string, Entry> table;     ///< entries in the file
+        mutable std::map          <string, Entry> pending;   ///< entries to be written
+
+        void map_file () const;
+
+        const Entry* find (const string fname) const;
+        const char*  data (const Entry& entry) const;
+
+        template <class type>
+        int  read_values  (const string fname,       vector<type> &values, Size &nrows, Size &ncols) const;
+        template <class type>
+        int write_values  (const string fname, const vector<type> &values, const Size rank, const Size ncols) const;
+
+        template <class type>
+        int  read_2D      (const string fname,       vector<vector<type>> &array) const;
+        template <class type>
+        int write_2D      (const string fname, const vector<vector<type>> &array) const;
+};
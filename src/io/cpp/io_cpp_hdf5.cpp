@@ -0,0 +1,1062 @@
+#include <cstring>
+
+#include "io_cpp_hdf5.hpp"
+
+
+///  HDF5 memory and file types corresponding to the C++ types used in io
+///  Integers and floating point numbers are stored as 64 bit, as in h5py.
+/////////////////////////////////////////////////////////////////////////
+template <class type> struct H5Type {};
+
+template <> struct H5Type <long>
+{
+    static hid_t mem  () {return H5T_NATIVE_LONG;}
+    static hid_t file () {return H5T_STD_I64LE;  }
+};
+
+template <> struct H5Type <unsigned int>
+{
+    static hid_t mem  () {return H5T_NATIVE_UINT;}
+    static hid_t file () {return H5T_STD_I64LE;  }
+};
+
+template <> struct H5Type <unsigned long>
+{
+    static hid_t mem  () {return H5T_NATIVE_ULONG;}
+    static hid_t file () {return H5T_STD_I64LE;   }
+};
+
+template <> struct H5Type <double>
+{
+    static hid_t mem  () {return H5T_NATIVE_DOUBLE;}
+    static hid_t file () {return H5T_IEEE_F64LE;   }
+};
+
+template <> struct H5Type <long double>
+{
+    static hid_t mem  () {return H5T_NATIVE_LDOUBLE;}
+    static hid_t file () {return H5T_IEEE_F64LE;    }
+};
+
+
+///  Split a name of the form "object.attribute" into object and attribute
+///    @param[in]  name      : name to split
+///    @param[out] object    : (HDF5 path to the) object, "." for the root
+///    @param[out] attribute : name of the attribute
+/////////////////////////////////////////////////////////////////////////
+inline void split_attribute_name (const string name, string &object, string &attribute)
+{
+    const size_t pos = name.find ('.');
+
+    object    = name.substr (0, pos);
+    attribute = name.substr (pos+1);
+
+    // Remove trailing slashes
+    while (!object.empty() && (object.back() == '/')) {object.pop_back();}
+
+    if (object.empty()) {object = ".";}
+}
+
+
+///  Callback for H5Literate, counting the links containing a given string
+/////////////////////////////////////////////////////////////////////////
+herr_t count_links (hid_t group, const char *name, const H5L_info_t *info, void *data)
+{
+    std::pair<string, Size> *counter = static_cast<std::pair<string, Size>*> (data);
+
+    if (string (name).find (counter->first) != string::npos) {counter->second++;}
+
+    return 0;
+}
+
+
+///  Constructor for IoHdf5, opens the HDF5 file if it exists
+///  A file that does not exist yet is only created by the first write, so
+///  that reading from a mistyped file name fails instead of giving an
+///  empty model.
+///    @param[in] io_file : file to read from and write to
+//////////////////////////////////////////////////////////////////////////
+IoHdf5 :: IoHdf5 (const string &io_file) : Io (io_file)
+{
+    // Probe the access modes, a failing open is not an error here
+    H5E_BEGIN_TRY
+    {
+                      file = H5Fopen (io_file.c_str(), H5F_ACC_RDWR,   H5P_DEFAULT);
+        if (file < 0) file = H5Fopen (io_file.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    }
+    H5E_END_TRY;
+}
+
+
+///  Destructor for IoHdf5, closes the HDF5 file
+////////////////////////////////////////////////
+IoHdf5 :: ~IoHdf5 ()
+{
+    if (file >= 0) {H5Fclose (file);}
+}
+
+
+///  Check if an object (group or dataset) exists in the file
+///    @param[in] name : HDF5 path to the object
+////////////////////////////////////////////////////////////
+bool IoHdf5 :: exists (const string name) const
+{
+    // All readers check for existence first, so they fail on a missing file
+    if (file < 0)
+    {
+        throw std::runtime_error ("Could not open HDF5 file: " + io_file);
+    }
+
+    if (name.empty() || (name == ".")) {return true;}
+
+    size_t pos = 0;
+
+    // Check all intermediate groups first, as required by H5Lexists
+    while (pos != string::npos)
+    {
+        pos = name.find ('/', pos+1);
+
+        const string path = name.substr (0, pos);
+
+        if (!path.empty() && (path.back() != '/'))
+        {
+            if (H5Lexists (file, path.c_str(), H5P_DEFAULT) <= 0) {return false;}
+        }
+    }
+
+    return true;
+}
+
+
+///  Create all groups in the given path (if they do not exist yet)
+///  The last component of the path is only created if it ends in a "/".
+///  All writers start here, so this also creates the file if required.
+///    @param[in] name : HDF5 path
+////////////////////////////////////////////////////////////////////////
+int IoHdf5 :: create_groups (const string name) const
+{
+    if (file < 0)
+    {
+        file = H5Fcreate (io_file.c_str(), H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+
+        if (file < 0)
+        {
+            throw std::runtime_error ("Could not create HDF5 file: " + io_file);
+        }
+    }
+
+    size_t pos = name.find ('/');
+
+    while (pos != string::npos)
+    {
+        const string group = name.substr (0, pos);
+
+        if (!group.empty() && !exists (group))
+        {
+            hid_t g = H5Gcreate2 (file, group.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+            if (g < 0) {return (-1);}
+
+            H5Gclose (g);
+        }
+
+        pos = name.find ('/', pos+1);
+    }
+
+    return (0);
+}
+
+
+///  Reader for a (numeric) attribute
+///    @param[in]  file_name : name of the attribute, as "object.attribute"
+///    @param[out] value     : value to be read
+///////////////////////////////////////////////////////////////////////////
+template <class type>
+int IoHdf5 :: read_attribute (const string file_name, type &value) const
+{
+    string object, attribute;
+    split_attribute_name (file_name, object, attribute);
+
+    if (!exists (object))                                                        {return (-1);}
+    if (H5Aexists_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT) <= 0) {return (-1);}
+
+    hid_t attr = H5Aopen_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT, H5P_DEFAULT);
+
+    const herr_t err = H5Aread (attr, H5Type<type>::mem(), &value);
+
+    H5Aclose (attr);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Writer for a (numeric) attribute, overwrites an existing one
+///    @param[in] file_name : name of the attribute, as "object.attribute"
+///    @param[in] value     : value to be written
+//////////////////////////////////////////////////////////////////////////
+template <class type>
+int IoHdf5 :: write_attribute (const string file_name, const type &value) const
+{
+    string object, attribute;
+    split_attribute_name (file_name, object, attribute);
+
+    if (create_groups (object + "/") != 0) {return (-1);}
+
+    if (H5Aexists_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT) > 0)
+    {
+        H5Adelete_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT);
+    }
+
+    hid_t space = H5Screate (H5S_SCALAR);
+    hid_t attr  = H5Acreate_by_name (file, object.c_str(), attribute.c_str(), H5Type<type>::file(),
+                                     space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    herr_t err = (attr < 0) ? -1 : H5Awrite (attr, H5Type<type>::mem(), &value);
+
+    if (attr >= 0) {H5Aclose (attr);}
+    H5Sclose (space);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Reader for a 1D or 2D dataset into contiguous (row major) memory
+///    @param[in]  file_name : name of the dataset
+///    @param[out] data      : data to be read
+///    @param[out] nrows     : number of rows (length)
+///    @param[out] ncols     : number of columns (width), 1 for 1D datasets
+/////////////////////////////////////////////////////////////////////////
+template <class type>
+int IoHdf5 :: read_dataset (const string file_name, vector<type> &data, Size &nrows, Size &ncols) const
+{
+    if (!exists (file_name)) {return (-1);}
+
+    hid_t dset  = H5Dopen2 (file, file_name.c_str(), H5P_DEFAULT);
+
+    if (dset < 0) {return (-1);}
+
+    hid_t space = H5Dget_space (dset);
+
+    const int rank = H5Sget_simple_extent_ndims (space);
+
+    hsize_t dims[2] = {0, 1};
+
+    herr_t err = -1;
+
+    if ((rank == 1) || (rank == 2))
+    {
+        H5Sget_simple_extent_dims (space, dims, NULL);
+
+        nrows = dims[0];
+        ncols = dims[1];
+
+        data.resize (nrows*ncols);
+
+        err = H5Dread (dset, H5Type<type>::mem(), H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data());
+    }
+
+    H5Sclose (space);
+    H5Dclose (dset);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Writer for a 1D or 2D dataset from contiguous (row major) memory
+///  An existing dataset with the same name is replaced.
+///    @param[in] file_name : name of the dataset
+///    @param[in] data      : data to be written
+///    @param[in] nrows     : number of rows (length)
+///    @param[in] ncols     : number of columns (width), 0 for a 1D dataset
+//////////////////////////////////////////////////////////////////////////
+template <class type>
+int IoHdf5 :: write_dataset (const string file_name, const vector<type> &data, const Size nrows, const Size ncols) const
+{
+    if (create_groups (file_name) != 0) {return (-1);}
+
+    if (exists (file_name)) {H5Ldelete (file, file_name.c_str(), H5P_DEFAULT);}
+
+    const hsize_t dims[2] = {nrows, ncols};
+
+    hid_t space = H5Screate_simple ((ncols == 0) ? 1 : 2, dims, NULL);
+    hid_t dset  = H5Dcreate2 (file, file_name.c_str(), H5Type<type>::file(), space,
+                              H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    herr_t err = (dset < 0) ? -1 : H5Dwrite (dset, H5Type<type>::mem(), H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data());
+
+    if (dset >= 0) {H5Dclose (dset);}
+    H5Sclose (space);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Reader for a 2D dataset into a vector of vectors
+///    @param[in]  file_name : name of the dataset
+///    @param[out] array     : array to be read
+///////////////////////////////////////////////////////
+template <class type>
+int IoHdf5 :: read_2D (const string file_name, vector<vector<type>> &array) const
+{
+    vector<type> buffer;
+    Size nrows, ncols;
+
+    const int err = read_dataset (file_name, buffer, nrows, ncols);
+
+    if (err == 0)
+    {
+        array.resize (nrows);
+
+        for (Size i = 0; i < nrows; i++)
+        {
+            array[i].assign (buffer.begin() + i*ncols, buffer.begin() + (i+1)*ncols);
+        }
+    }
+
+    return err;
+}
+
+
+///  Writer for a vector of vectors into a 2D dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] array     : array to be written (all rows of equal length)
+////////////////////////////////////////////////////////////////////////////
+template <class type>
+int IoHdf5 :: write_2D (const string file_name, const vector<vector<type>> &array) const
+{
+    if (array.size() == 0) {return (0);}
+
+    const Size nrows = array.size();
+    const Size ncols = array[0].size();
+
+    vector<type> buffer;
+    buffer.reserve (nrows*ncols);
+
+    for (const vector<type> &row : array)
+    {
+        if (row.size() != ncols) {return (-1);}
+
+        buffer.insert (buffer.end(), row.begin(), row.end());
+    }
+
+    return write_dataset (file_name, buffer, nrows, ncols);
+}
+
+
+///  Reader for the length of a dataset, or the number of objects in a group
+///  of which the name contains the last part of the given name
+///    @param[in]  file_name : path to file containing the data
+///    @param[out] length    : length to be read
+////////////////////////////////////////////////////////////////////////////
+int IoHdf5 :: read_length (const string file_name, Size &length) const
+{
+    length = 0;
+
+    if (exists (file_name))
+    {
+        hid_t dset;
+
+        // The object might be a group, which is not an error here
+        H5E_BEGIN_TRY {dset = H5Dopen2 (file, file_name.c_str(), H5P_DEFAULT);} H5E_END_TRY;
+
+        if (dset >= 0)
+        {
+            hid_t   space   = H5Dget_space (dset);
+            hsize_t dims[2] = {0, 0};
+
+            H5Sget_simple_extent_dims (space, dims, NULL);
+
+            length = dims[0];
+
+            H5Sclose (space);
+            H5Dclose (dset);
+
+            return (0);
+        }
+    }
+
+    // Count the number of objects with a similar name
+    const size_t pos    = file_name.rfind ('/');
+    const string object = (pos == string::npos) ? file_name : file_name.substr (pos+1);
+          string group  = (pos == string::npos) ? "."       : file_name.substr (0, pos);
+
+    if (group.empty()) {group = ".";}
+
+    if (!exists (group)) {return (0);}
+
+    std::pair<string, Size> counter (object, 0);
+
+    hid_t g;
+
+    H5E_BEGIN_TRY {g = H5Gopen2 (file, group.c_str(), H5P_DEFAULT);} H5E_END_TRY;
+
+    if (g >= 0)
+    {
+        H5Literate (g, H5_INDEX_NAME, H5_ITER_NATIVE, NULL, count_links, &counter);
+        H5Gclose   (g);
+    }
+
+    length = counter.second;
+
+    return (0);
+}
+
+
+///  Getter for the length of a dataset
+///    @param[in]  file_name : path to file containing the data
+///    @returns length of the dataset
+///////////////////////////////////////////////////////////////
+Size IoHdf5 :: get_length (const string file_name) const
+{
+    Size length;
+    read_length (file_name, length);
+    return length;
+}
+
+
+///  Reader for the number of columns (width) of a dataset
+///  or the number of objects with a similar name
+///    @param[in]  file_name : path to file containing the data
+///    @param[out] width     : width to be read
+///////////////////////////////////////////////////////////////
+int IoHdf5 :: read_width (const string file_name, Size &width) const
+{
+    if (exists (file_name))
+    {
+        hid_t dset;
+
+        // The object might be a group, which is not an error here
+        H5E_BEGIN_TRY {dset = H5Dopen2 (file, file_name.c_str(), H5P_DEFAULT);} H5E_END_TRY;
+
+        if (dset >= 0)
+        {
+            hid_t   space   = H5Dget_space (dset);
+            hsize_t dims[2] = {0, 0};
+
+            const int rank = H5Sget_simple_extent_ndims (space);
+
+            H5Sget_simple_extent_dims (space, dims, NULL);
+
+            width = dims[1];
+
+            H5Sclose (space);
+            H5Dclose (dset);
+
+            return (rank == 2) ? 0 : -1;
+        }
+    }
+
+    return read_length (file_name, width);
+}
+
+
+///  Getter for the number of columns (width) of a dataset
+///  or the number of objects with a similar name
+///    @param[in]  file_name : path to file containing the data
+///    @returns width of the dataset
+///////////////////////////////////////////////////////////////
+Size IoHdf5 :: get_width (const string file_name) const
+{
+    Size width;
+    read_width (file_name, width);
+    return width;
+}
+
+
+///  Reader for a single (long integer) number from an attribute
+///    @param[in]  file_name : name of the attribute
+///    @param[out] number    : number to be read
+////////////////////////////////////////////////////////////////
+int IoHdf5 :: read_number (const string file_name, long &number) const
+{
+    return read_attribute <long> (file_name, number);
+}
+
+
+///  Writer for a single (long integer) number to an attribute
+///    @param[in] file_name : name of the attribute
+///    @param[in] number    : number to be written
+//////////////////////////////////////////////////////////////
+int IoHdf5 :: write_number (const string file_name, const long &number) const
+{
+    return write_attribute <long> (file_name, number);
+}
+
+
+///  Reader for a single (Size) number from an attribute
+///    @param[in]  file_name : name of the attribute
+///    @param[out] number    : number to be read
+////////////////////////////////////////////////////////
+int IoHdf5 :: read_number (const string file_name, Size &number) const
+{
+    return read_attribute <Size> (file_name, number);
+}
+
+
+///  Writer for a single (Size) number to an attribute
+///    @param[in] file_name : name of the attribute
+///    @param[in] number    : number to be written
+//////////////////////////////////////////////////////
+int IoHdf5 :: write_number (const string file_name, const Size &number) const
+{
+    return write_attribute <Size> (file_name, number);
+}
+
+
+///  Reader for a single (Real) number from an attribute
+///    @param[in]  file_name : name of the attribute
+///    @param[out] number    : number to be read
+////////////////////////////////////////////////////////
+int IoHdf5 :: read_number (const string file_name, Real &number) const
+{
+    return read_attribute <Real> (file_name, number);
+}
+
+
+///  Writer for a single (Real) number to an attribute
+///    @param[in] file_name : name of the attribute
+///    @param[in] number    : number to be written
+//////////////////////////////////////////////////////
+int IoHdf5 :: write_number (const string file_name, const Real &number) const
+{
+    return write_attribute <Real> (file_name, number);
+}
+
+
+///  Reader for a single string from an attribute
+///  Both variable length (h5py default) and fixed length strings are accepted.
+///    @param[in]  file_name : name of the attribute
+///    @param[out] word      : string to be read
+///////////////////////////////////////////////////////////////////////////////
+int IoHdf5 :: read_word (const string file_name, string &word) const
+{
+    string object, attribute;
+    split_attribute_name (file_name, object, attribute);
+
+    if (!exists (object))                                                        {return (-1);}
+    if (H5Aexists_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT) <= 0) {return (-1);}
+
+    hid_t attr  = H5Aopen_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT, H5P_DEFAULT);
+    hid_t ftype = H5Aget_type (attr);
+    hid_t mtype = H5Tcopy (H5T_C_S1);
+
+    herr_t err = -1;
+
+    if (H5Tis_variable_str (ftype) > 0)
+    {
+        H5Tset_size (mtype, H5T_VARIABLE);
+        H5Tset_cset (mtype, H5Tget_cset (ftype));
+
+        char *buffer = NULL;
+
+        err = H5Aread (attr, mtype, &buffer);
+
+        if ((err >= 0) && (buffer != NULL))
+        {
+            word = buffer;
+            H5free_memory (buffer);
+        }
+    }
+    else
+    {
+        const size_t size = H5Tget_size (ftype);
+
+        H5Tset_size   (mtype, size);
+        H5Tset_strpad (mtype, H5T_STR_NULLPAD);
+
+        vector<char> buffer (size);
+
+        err = H5Aread (attr, mtype, buffer.data());
+
+        if (err >= 0) {word = string (buffer.data(), strnlen (buffer.data(), size));}
+    }
+
+    H5Tclose (mtype);
+    H5Tclose (ftype);
+    H5Aclose (attr);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Writer for a single string to an attribute (variable length, UTF-8)
+///    @param[in] file_name : name of the attribute
+///    @param[in] word      : string to be written
+////////////////////////////////////////////////////////////////////////
+int IoHdf5 :: write_word (const string file_name, const string &word) const
+{
+    string object, attribute;
+    split_attribute_name (file_name, object, attribute);
+
+    if (create_groups (object + "/") != 0) {return (-1);}
+
+    if (H5Aexists_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT) > 0)
+    {
+        H5Adelete_by_name (file, object.c_str(), attribute.c_str(), H5P_DEFAULT);
+    }
+
+    hid_t type  = H5Tcopy (H5T_C_S1);
+    H5Tset_size (type, H5T_VARIABLE);
+    H5Tset_cset (type, H5T_CSET_UTF8);
+
+    hid_t space = H5Screate (H5S_SCALAR);
+    hid_t attr  = H5Acreate_by_name (file, object.c_str(), attribute.c_str(), type,
+                                     space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    const char *buffer = word.c_str();
+
+    herr_t err = (attr < 0) ? -1 : H5Awrite (attr, type, &buffer);
+
+    if (attr >= 0) {H5Aclose (attr);}
+    H5Sclose (space);
+    H5Tclose (type);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Reader for a single boolean from an attribute
+///    @param[in]  file_name : name of the attribute
+///    @param[out] value     : value to be read
+////////////////////////////////////////////////////
+int IoHdf5 :: read_bool (const string file_name, bool &value) const
+{
+    // Treat booleans as text in io
+    string word;
+
+    int err = read_word (file_name, word);
+
+    if      (word.compare("true" ) == 0) {value = true; }
+    else if (word.compare("false") == 0) {value = false;}
+    else                                 {  err = -1;   }
+
+    return err;
+}
+
+
+///  Writer for a single boolean to an attribute
+///    @param[in] file_name : name of the attribute
+///    @param[in] value     : value to be written
+/////////////////////////////////////////////////////
+int IoHdf5 :: write_bool (const string file_name, const bool &value) const
+{
+    // Treat booleans as text in io
+    string word = "false";
+
+    if (value) {word = "true";}
+
+    return write_word (file_name, word);
+}
+
+
+///  Reader for a list of long integers from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] list      : list to be read
+//////////////////////////////////////////////////////
+int IoHdf5 :: read_list (const string file_name, Long1 &list) const
+{
+    Size nrows, ncols;
+    return read_dataset (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of long integers to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] list      : list to be written
+////////////////////////////////////////////////////
+int IoHdf5 :: write_list (const string file_name, const Long1 &list) const
+{
+    if (list.size() == 0) {return (0);}
+    return write_dataset (file_name, list, list.size(), 0);
+}
+
+
+///  Reader for a list of doubles from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] list      : list to be read
+////////////////////////////////////////////////
+int IoHdf5 :: read_list (const string file_name, Double1 &list) const
+{
+    Size nrows, ncols;
+    return read_dataset (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of doubles to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] list      : list to be written
+////////////////////////////////////////////////
+int IoHdf5 :: write_list (const string file_name, const Double1 &list) const
+{
+    if (list.size() == 0) {return (0);}
+    return write_dataset (file_name, list, list.size(), 0);
+}
+
+
+///  Reader for a list of size_t's from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] list      : list to be read
+////////////////////////////////////////////////
+int IoHdf5 :: read_list (const string file_name, Size_t1 &list) const
+{
+    Size nrows, ncols;
+    return read_dataset (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of size_t's to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] list      : list to be written
+////////////////////////////////////////////////
+int IoHdf5 :: write_list (const string file_name, const Size_t1 &list) const
+{
+    if (list.size() == 0) {return (0);}
+    return write_dataset (file_name, list, list.size(), 0);
+}
+
+
+///  Reader for a list of Reals from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] list      : list to be read
+////////////////////////////////////////////////
+int IoHdf5 :: read_list (const string file_name, Real1 &list) const
+{
+    Size nrows, ncols;
+    return read_dataset (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of Reals to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] list      : list to be written
+////////////////////////////////////////////////
+int IoHdf5 :: write_list (const string file_name, const Real1 &list) const
+{
+    if (list.size() == 0) {return (0);}
+    return write_dataset (file_name, list, list.size(), 0);
+}
+
+
+///  Reader for a list of Sizes from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] list      : list to be read
+////////////////////////////////////////////////
+int IoHdf5 :: read_list (const string file_name, Size1 &list) const
+{
+    Size nrows, ncols;
+    return read_dataset (file_name, list, nrows, ncols);
+}
+
+
+///  Writer for a list of Sizes to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] list      : list to be written
+////////////////////////////////////////////////
+int IoHdf5 :: write_list (const string file_name, const Size1 &list) const
+{
+    if (list.size() == 0) {return (0);}
+    return write_dataset (file_name, list, list.size(), 0);
+}
+
+
+///  Reader for a list of strings from a dataset
+///  Both variable length and fixed length (numpy "S") strings are accepted.
+///    @param[in]  file_name : name of the dataset
+///    @param[out] list      : list to be read
+////////////////////////////////////////////////////////////////////////////
+int IoHdf5 :: read_list (const string file_name, String1 &list) const
+{
+    if (!exists (file_name)) {return (-1);}
+
+    hid_t dset  = H5Dopen2 (file, file_name.c_str(), H5P_DEFAULT);
+
+    if (dset < 0) {return (-1);}
+
+    hid_t space = H5Dget_space (dset);
+    hid_t ftype = H5Dget_type  (dset);
+    hid_t mtype = H5Tcopy      (H5T_C_S1);
+
+    hsize_t dims[2] = {0, 1};
+    H5Sget_simple_extent_dims (space, dims, NULL);
+
+    const Size length = dims[0];
+
+    herr_t err = -1;
+
+    if (H5Tis_variable_str (ftype) > 0)
+    {
+        H5Tset_size (mtype, H5T_VARIABLE);
+        H5Tset_cset (mtype, H5Tget_cset (ftype));
+
+        vector<char*> buffer (length, NULL);
+
+        err = H5Dread (dset, mtype, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data());
+
+        if (err >= 0)
+        {
+            list.resize (length);
+
+            for (Size i = 0; i < length; i++)
+            {
+                list[i] = (buffer[i] != NULL) ? buffer[i] : "";
+            }
+
+            H5Dvlen_reclaim (mtype, space, H5P_DEFAULT, buffer.data());
+        }
+    }
+    else
+    {
+        const size_t size = H5Tget_size (ftype);
+
+        H5Tset_size   (mtype, size);
+        H5Tset_strpad (mtype, H5T_STR_NULLPAD);
+
+        vector<char> buffer (length*size);
+
+        err = H5Dread (dset, mtype, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data());
+
+        if (err >= 0)
+        {
+            list.resize (length);
+
+            for (Size i = 0; i < length; i++)
+            {
+                const char *word = buffer.data() + i*size;
+
+                list[i] = string (word, strnlen (word, size));
+            }
+        }
+    }
+
+    H5Tclose (mtype);
+    H5Tclose (ftype);
+    H5Sclose (space);
+    H5Dclose (dset);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Writer for a list of strings to a dataset (fixed length, as numpy "S")
+///    @param[in] file_name : name of the dataset
+///    @param[in] list      : list to be written
+///////////////////////////////////////////////////////////////////////////
+int IoHdf5 :: write_list (const string file_name, const String1 &list) const
+{
+    if (list.size() == 0) {return (0);}
+
+    size_t size = 1;
+
+    for (const string &word : list) {size = std::max (size, word.size());}
+
+    vector<char> buffer (list.size()*size, '\0');
+
+    for (Size i = 0; i < list.size(); i++)
+    {
+        std::memcpy (buffer.data() + i*size, list[i].data(), list[i].size());
+    }
+
+    if (create_groups (file_name) != 0) {return (-1);}
+
+    if (exists (file_name)) {H5Ldelete (file, file_name.c_str(), H5P_DEFAULT);}
+
+    const hsize_t dims[1] = {list.size()};
+
+    hid_t type  = H5Tcopy (H5T_C_S1);
+    H5Tset_size   (type, size);
+    H5Tset_strpad (type, H5T_STR_NULLPAD);
+
+    hid_t space = H5Screate_simple (1, dims, NULL);
+    hid_t dset  = H5Dcreate2 (file, file_name.c_str(), type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    herr_t err = (dset < 0) ? -1 : H5Dwrite (dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data());
+
+    if (dset >= 0) {H5Dclose (dset);}
+    H5Sclose (space);
+    H5Tclose (type);
+
+    return (err < 0) ? -1 : 0;
+}
+
+
+///  Reader for an array of long integers from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] array     : array to be read
+////////////////////////////////////////////////////////
+int IoHdf5 :: read_array (const string file_name, Long2 &array) const
+{
+    return read_2D (file_name, array);
+}
+
+
+///  Writer for an array of long integers to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] array     : array to be written
+//////////////////////////////////////////////////////
+int IoHdf5 :: write_array (const string file_name, const Long2 &array) const
+{
+    return write_2D (file_name, array);
+}
+
+
+///  Reader for an array of doubles from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] array     : array to be read
+////////////////////////////////////////////////////
+int IoHdf5 :: read_array (const string file_name, Double2 &array) const
+{
+    return read_2D (file_name, array);
+}
+
+
+///  Writer for an array of doubles to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] array     : array to be written
+//////////////////////////////////////////////////
+int IoHdf5 :: write_array (const string file_name, const Double2 &array) const
+{
+    return write_2D (file_name, array);
+}
+
+
+///  Reader for an array of Reals from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] array     : array to be read
+////////////////////////////////////////////////////
+int IoHdf5 :: read_array (const string file_name, Real2 &array) const
+{
+    return read_2D (file_name, array);
+}
+
+
+///  Writer for an array of Reals to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] array     : array to be written
+//////////////////////////////////////////////////
+int IoHdf5 :: write_array (const string file_name, const Real2 &array) const
+{
+    return write_2D (file_name, array);
+}
+
+
+///  Reader for a list of 3-vectors from an (N x 3) dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] v         : vector of 3-vectors to be read
+///////////////////////////////////////////////////////////////
+int IoHdf5 :: read_array (const string file_name, Vector<Vector3D> &v) const
+{
+    vector<double> buffer;
+    Size nrows, ncols;
+
+    int err = read_dataset (file_name, buffer, nrows, ncols);
+
+    if ((err == 0) && (ncols != 3)) {err = -1;}
+
+    if (err == 0)
+    {
+        v.vec.resize (nrows);
+
+        for (Size p = 0; p < nrows; p++)
+        {
+            v.vec[p] = Vector3D (buffer[3*p], buffer[3*p+1], buffer[3*p+2]);
+        }
+
+        v.set_dat ();
+    }
+
+    return err;
+}
+
+
+///  Writer for a list of 3-vectors to an (N x 3) dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] v         : vector of 3-vectors to be written
+///////////////////////////////////////////////////////////////
+int IoHdf5 :: write_array (const string file_name, const Vector<Vector3D> &v) const
+{
+    if (v.vec.size() == 0) {return (0);}
+
+    vector<double> buffer (3*v.vec.size());
+
+    for (Size p = 0; p < v.vec.size(); p++)
+    {
+        buffer[3*p  ] = v.vec[p].x();
+        buffer[3*p+1] = v.vec[p].y();
+        buffer[3*p+2] = v.vec[p].z();
+    }
+
+    return write_dataset (file_name, buffer, v.vec.size(), 3);
+}
+
+
+///  Reader for a list of 3-vectors of doubles from a dataset
+///    @param[in]  file_name : name of the dataset
+///    @param[out] x         : x component of the vector to be read
+///    @param[out] y         : y component of the vector to be read
+///    @param[out] z         : z component of the vector to be read
+///////////////////////////////////////////////////////////////////
+int IoHdf5 :: read_3_vector (
+        const string   file_name,
+              Double1 &x,
+              Double1 &y,
+              Double1 &z         ) const
+{
+    const Size length = x.size();
+
+    // Check if all 3 vectors are the same size
+    if (   (length != y.size())
+        || (length != z.size()) )
+    {
+        return (-1);
+    }
+
+    Double2 array;
+
+    int err = read_2D (file_name, array);
+
+    if ((err == 0) && (array.size() == length))
+    {
+        for (Size p = 0; p < length; p++)
+        {
+            x[p] = array[p][0];
+            y[p] = array[p][1];
+            z[p] = array[p][2];
+        }
+    }
+
+    return err;
+}
+
+
+///  Writer for a list of 3-vectors of doubles to a dataset
+///    @param[in] file_name : name of the dataset
+///    @param[in] x         : x component of the vector to be written
+///    @param[in] y         : y component of the vector to be written
+///    @param[in] z         : z component of the vector to be written
+/////////////////////////////////////////////////////////////////////
+int IoHdf5 :: write_3_vector (
+        const string   file_name,
+        const Double1 &x,
+        const Double1 &y,
+        const Double1 &z         ) const
+{
+    const Size length = x.size();
+
+    // Check if all 3 vectors are the same size
+    if (   (length != y.size())
+        || (length != z.size()) )
+    {
+        return (-1);
+    }
+
+    Double2 array (length, Double1 (3));
+
+    for (Size p = 0; p < length; p++)
+    {
+        array[p][0] = x[p];
+        array[p][1] = y[p];
+        array[p][2] = z[p];
+    }
+
+    return write_2D (file_name, array);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+
+#include <hdf5.h>
+
+#include "io/io.hpp"
+#include "tools/types.hpp"
+
+
+///  IoHdf5: io specified by an HDF5 file, using the HDF5 C library
+///  The layout is the same as the one used by IoPython ("hdf5"), i.e.
+///  names starting with a "." are attributes, all others are datasets.
+///  The file is opened once in the constructor (or created by the first
+///  write if it does not exist yet) and closed on destruction.
+/////////////////////////////////////////////////////////////////////////
+
+struct IoHdf5 : public Io
+{
+    public:
+        // Constructor and destructor
+        IoHdf5 (const string &io_file);
+       ~IoHdf5 ();
+
+        // The file handle can not be shared between copies
+        IoHdf5 (const IoHdf5&) = delete;
+        IoHdf5& operator= (const IoHdf5&) = delete;
+
+        int  read_length   (const string fname,       Size    &length) const override;
+        Size  get_length   (const string fname                       ) const override;
+
+        int  read_width    (const string fname,       Size    &width ) const override;
+        Size  get_width    (const string fname                       ) const override;
+
+        int  read_number   (const string fname,       long    &number) const override;
+        int write_number   (const string fname, const long    &number) const override;
+
+        int  read_number   (const string fname,       Size    &number) const override;
+        int write_number   (const string fname, const Size    &number) const override;
+
+        int  read_number   (const string fname,       Real    &number) const override;
+        int write_number   (const string fname, const Real    &number) const override;
+
+        int  read_word     (const string fname,       string  &word  ) const override;
+        int write_word     (const string fname, const string  &word  ) const override;
+
+        int  read_bool     (const string fname,       bool    &value ) const override;
+        int write_bool     (const string fname, const bool    &value ) const override;
+
+        int  read_list     (const string fname,       Long1   &list  ) const override;
+        int write_list     (const string fname, const Long1   &list  ) const override;
+
+        int  read_list     (const string fname,       Double1 &list  ) const override;
+        int write_list     (const string fname, const Double1 &list  ) const override;
+
+        int  read_list     (const string fname,       Size_t1 &list  ) const override;
+        int write_list     (const string fname, const Size_t1 &list  ) const override;
+
+        int  read_list     (const string fname,       Real1   &list  ) const override;
+        int write_list     (const string fname, const Real1   &list  ) const override;
+
+        int  read_list     (const string fname,       Size1   &list  ) const override;
+        int write_list     (const string fname, const Size1   &list  ) const override;
+
+        int  read_list     (const string fname,       String1 &list  ) const override;
+        int write_list     (const string fname, const String1 &list  ) const override;
+
+        int  read_array    (const string fname,       Long2   &array ) const override;
+        int write_array    (const string fname, const Long2   &array ) const override;
+
+        int  read_array    (const string fname,       Double2 &array ) const override;
+        int write_array    (const string fname, const Double2 &array ) const override;
+
+        int  read_array    (const string fname,       Real2   &array ) const override;
+        int write_array    (const string fname, const Real2   &array ) const override;
+
+        int  read_array    (const string fname,       Vector<Vector3D> &v) const override;
+        int write_array    (const string fname, const Vector<Vector3D> &v) const override;
+
+        int  read_3_vector (const string fname,       Double1 &x,
+                                                      Double1 &y,
+                                                      Double1 &z     ) const override;
+        int write_3_vector (const string fname, const Double1 &x,
+                                                const Double1 &y,
+                                                const Double1 &z     ) const override;
+
+
+    private:
+        mutable hid_t file;   ///< handle to the (open) HDF5 file, negative if not open yet
+
+        bool exists (const string name) const;
+        int  create_groups (const string name) const;
+
+        template <class type>
+        int  read_attribute  (const string fname,       type &value) const;
+        template <class type>
+        int write_attribute  (const string fname, const type &value) const;
+
+        template <class type>
+        int  read_dataset    (const string fname,       vector<type> &data, Size &nrows, Size &ncols) const;
+        template <class type>
+        int write_dataset    (const string fname, const vector<type> &data, const Size nrows, const Size ncols) const;
+
+        template <class type>
+        int  read_2D         (const string fname,       vector<vector<type>> &array) const;
+        template <class type>
+        int write_2D         (const string fname, const vector<vector<type>> &array) const;
+};
@@ -1,8 +1,14 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <sys/stat.h>
 #include <iomanip>
+#include <limits>
 
 #include "io_cpp_text.hpp"
+#include "mapped_file.hpp"
 
 
 ///  Constructor for IoText
@@ -21,6 +27,505 @@ bool pathExist (const string &path)
 }
 
 
+///  Check if a character is white space (separating tokens)
+///    @param[in] c : character to check
+////////////////////////////////////////////////////////////
+inline bool is_space (const char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+
+///  Check if a character is a decimal digit
+///    @param[in] c : character to check
+////////////////////////////////////////////
+inline bool is_digit (const char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+
+///  Getter for an exactly representable power of ten
+///    @param[in] exponent : power of ten (at most max_exact_exponent)
+///    @return 10^exponent
+/////////////////////////////////////////////////////////////////////
+inline long double power_of_ten (const int exponent)
+{
+    static const vector<long double> table = []
+    {
+        // Repeated multiplication, which is exact for these powers
+        vector<long double> t (28, 1.0L);
+
+        for (size_t e = 1; e < t.size(); e++) {t[e] = 10.0L * t[e-1];}
+
+        return t;
+    }();
+
+    return table[exponent];
+}
+
+
+///  Standard library conversion of a token, rounded directly to the type
+//////////////////////////////////////////////////////////////////////////
+inline long double string_to_float (const char* str, char** stop, long double) {return std::strtold (str, stop);}
+inline double      string_to_float (const char* str, char** stop, double     ) {return std::strtod  (str, stop);}
+
+
+///  Locale independent parser for a floating point number
+///  The fast path is only taken when the result is correctly rounded, i.e.
+///  when both the mantissa and the power of ten are exactly representable
+///  in the type (such that there is only one rounding, in the final multiply
+///  or divide). Anything else (more digits, large exponents, inf, nan or
+///  hexadecimal floats) falls back to the standard library.
+///    @param[in]  ptr   : start of the token
+///    @param[in]  end   : end of the token
+///    @param[out] value : parsed value
+///    @return false if the token is not a number
+/////////////////////////////////////////////////////////////////////////////
+template <class type>
+inline bool parse_float (const char* ptr, const char* end, type &value)
+{
+    // Exactly representable mantissas and powers of ten (double: 2^53 and 10^22)
+    const int      digits       = std::numeric_limits<type>::digits;
+    const uint64_t max_mantissa = (digits >= 64) ? UINT64_MAX : (uint64_t(1) << digits);
+    const int      max_exponent = (digits >= 64) ? 27         : 22;
+
+    const char* start = ptr;
+
+    bool negative = false;
+
+    if ((ptr < end) && ((*ptr == '-') || (*ptr == '+')))
+    {
+        negative = (*ptr == '-');
+        ptr++;
+    }
+
+    // Only the first 19 significant digits fit in the mantissa
+    uint64_t mantissa = 0;
+    int      exponent = 0;
+    int      ndigits  = 0;
+    bool     found    = false;
+    bool     exact    = true;
+
+    for (; (ptr < end) && is_digit (*ptr); ptr++)
+    {
+        found = true;
+
+        if (ndigits < 19)
+        {
+            mantissa = 10*mantissa + (*ptr - '0');
+            if (mantissa > 0) {ndigits++;}
+        }
+        else
+        {
+            exact = false;
+            exponent++;
+        }
+    }
+
+    if ((ptr < end) && (*ptr == '.'))
+    {
+        for (ptr++; (ptr < end) && is_digit (*ptr); ptr++)
+        {
+            found = true;
+
+            if (ndigits < 19)
+            {
+                mantissa = 10*mantissa + (*ptr - '0');
+                if (mantissa > 0) {ndigits++;}
+                exponent--;
+            }
+            else
+            {
+                exact = false;
+            }
+        }
+    }
+
+    if (found && (ptr < end) && ((*ptr == 'e') || (*ptr == 'E')))
+    {
+        ptr++;
+
+        bool negative_exp = false;
+
+        if ((ptr < end) && ((*ptr == '-') || (*ptr == '+')))
+        {
+            negative_exp = (*ptr == '-');
+            ptr++;
+        }
+
+        int exp = 0;
+
+        if ((ptr == end) || !is_digit (*ptr)) {found = false;}
+
+        for (; (ptr < end) && is_digit (*ptr); ptr++)
+        {
+            if (exp < 100000) {exp = 10*exp + (*ptr - '0');}
+        }
+
+        exponent += negative_exp ? -exp : exp;
+    }
+
+    if (   found && exact && (ptr == end)
+        && (mantissa <= max_mantissa)
+        && (exponent >= -max_exponent) && (exponent <= max_exponent) )
+    {
+        const type m = mantissa;
+        const type p = power_of_ten (std::abs (exponent));
+
+        value = (exponent < 0) ? m / p : m * p;
+
+        if (negative) {value = -value;}
+
+        return true;
+    }
+
+    // Fall back to the (slow) standard library
+    const string token (start, end);
+    char* stop;
+
+    value = string_to_float (token.c_str(), &stop, type());
+
+    return (stop != token.c_str()) && (*stop == '\0');
+}
+
+
+///  Parsers for floating point numbers (see parse_float)
+/////////////////////////////////////////////////////////
+inline bool parse_value (const char* ptr, const char* end, long double &value) {return parse_float (ptr, end, value);}
+inline bool parse_value (const char* ptr, const char* end, double      &value) {return parse_float (ptr, end, value);}
+
+
+///  Parser for an integer, also accepts floating point notation
+///    @param[in]  ptr   : start of the token
+///    @param[in]  end   : end of the token
+///    @param[out] value : parsed value
+///    @return false if the token is not a number
+//////////////////////////////////////////////////////////////////
+template <class type>
+inline bool parse_integer (const char* ptr, const char* end, type &value)
+{
+    const char* start = ptr;
+
+    bool negative = false;
+
+    if ((ptr < end) && ((*ptr == '-') || (*ptr == '+')))
+    {
+        negative = (*ptr == '-');
+        ptr++;
+    }
+
+    type result = 0;
+
+    const char* first = ptr;
+
+    for (; (ptr < end) && is_digit (*ptr); ptr++)
+    {
+        result = 10*result + (*ptr - '0');
+    }
+
+    if ((ptr == end) && (ptr != first))
+    {
+        value = negative ? -result : result;
+        return true;
+    }
+
+    long double v;
+    const bool ok = parse_value (start, end, v);
+    value = (type) v;
+    return ok;
+}
+
+inline bool parse_value (const char* ptr, const char* end, long          &value) {return parse_integer (ptr, end, value);}
+inline bool parse_value (const char* ptr, const char* end, unsigned int  &value) {return parse_integer (ptr, end, value);}
+inline bool parse_value (const char* ptr, const char* end, unsigned long &value) {return parse_integer (ptr, end, value);}
+
+
+///  Parser for a string (the token itself)
+///////////////////////////////////////////
+inline bool parse_value (const char* ptr, const char* end, string &value)
+{
+    value.assign (ptr, end);
+    return true;
+}
+
+
+///  Divide a mapped file in (roughly) equal chunks, one for each thread,
+///  with boundaries on white space, such that no token or line is split
+///    @param[in] file    : mapped file
+///    @param[in] is_sep  : predicate for the characters to split on
+///    @return boundaries of the chunks (first = 0, last = file size)
+/////////////////////////////////////////////////////////////////////////
+template <class Predicate>
+inline vector<size_t> get_chunks (const MappedFile &file, Predicate is_sep)
+{
+    const size_t n_chunks = pc::multi_threading::n_threads_avail();
+
+    vector<size_t> bounds (n_chunks+1);
+
+    bounds[0]        = 0;
+    bounds[n_chunks] = file.size;
+
+    for (size_t c = 1; c < n_chunks; c++)
+    {
+        size_t b = std::max (bounds[c-1], (c * file.size) / n_chunks);
+
+        while ((b < file.size) && !is_sep (file.data[b])) {b++;}
+
+        bounds[c] = b;
+    }
+
+    return bounds;
+}
+
+
+///  Count the number of lines in a text file (as std::getline would)
+///    @param[in] fname : path to the file
+///    @return number of lines
+/////////////////////////////////////////////////////////////////////
+inline Size count_lines (const string &fname)
+{
+    MappedFile file;
+
+    // An empty file can not be mapped, and has no lines
+    if (!file.open (fname) || (file.size == 0)) {return 0;}
+
+    const vector<size_t> bounds = get_chunks (file, [] (const char c) {return c == '\n';});
+
+    vector<Size> count (bounds.size()-1, 0);
+
+    threaded_for (c, count.size(),
+    {
+        const char* ptr = file.data + bounds[c];
+        const char* end = file.data + bounds[c+1];
+
+        while ((ptr = static_cast<const char*> (memchr (ptr, '\n', end - ptr))) != nullptr)
+        {
+            count[c]++;
+            ptr++;
+        }
+    })
+
+    Size length = 0;
+
+    for (const Size n : count) {length += n;}
+
+    // Last line without a line break
+    if (file.data[file.size-1] != '\n') {length++;}
+
+    return length;
+}
+
+
+///  Read all (white space separated) tokens in a text file, in parallel
+///  Every thread first counts the tokens in its chunk of the file, after
+///  which they all parse their tokens directly into the right place.
+///    @param[in]  fname  : path to the file
+///    @param[out] values : parsed values
+///    @return 0 on success, -1 if the file could not be read or parsed
+////////////////////////////////////////////////////////////////////////
+template <class type>
+inline int read_tokens (const string &fname, vector<type> &values)
+{
+    MappedFile file;
+
+    // The values are only replaced on success
+    if (!file.open (fname))
+    {
+        struct stat info;
+
+        // An empty file can not be mapped, but holds an empty list
+        if ((stat (fname.c_str(), &info) != 0) || (info.st_size != 0)) {return (-1);}
+
+        values.clear();
+
+        return (0);
+    }
+
+    const vector<size_t> bounds = get_chunks (file, is_space);
+
+    const Size n_chunks = bounds.size()-1;
+
+    vector<size_t> first (n_chunks+1, 0);
+
+    threaded_for (c, n_chunks,
+    {
+        size_t count = 0;
+        bool   space = true;
+
+        for (size_t i = bounds[c]; i < bounds[c+1]; i++)
+        {
+            const bool s = is_space (file.data[i]);
+            if (space && !s) {count++;}
+            space = s;
+        }
+
+        first[c+1] = count;
+    })
+
+    for (Size c = 0; c < n_chunks; c++) {first[c+1] += first[c];}
+
+    vector<type> parsed (first[n_chunks]);
+
+    vector<char> failed (n_chunks, false);
+
+    threaded_for (c, n_chunks,
+    {
+        const char* ptr = file.data + bounds[c];
+        const char* end = file.data + bounds[c+1];
+
+        size_t index = first[c];
+
+        while (ptr < end)
+        {
+            while ((ptr < end) &&  is_space (*ptr)) {ptr++;}
+
+            const char* token = ptr;
+
+            while ((ptr < end) && !is_space (*ptr)) {ptr++;}
+
+            if (ptr > token)
+            {
+                if (!parse_value (token, ptr, parsed[index++])) {failed[c] = true;}
+            }
+        }
+    })
+
+    for (const char f : failed)
+    {
+        if (f) {return (-1);}
+    }
+
+    values.swap (parsed);
+
+    return (0);
+}
+
+
+///  Formatters for single values (same format as std::scientific with precision 16)
+///    @param[out] buffer : buffer to write to (at least 64 chars)
+///    @param[in]  value  : value to format
+///    @return number of characters written
+////////////////////////////////////////////////////////////////////////////////////
+inline int format_value (char* buffer, const long          value) {return snprintf (buffer, 64, "%ld",    value);}
+inline int format_value (char* buffer, const unsigned int  value) {return snprintf (buffer, 64, "%u",     value);}
+inline int format_value (char* buffer, const unsigned long value) {return snprintf (buffer, 64, "%lu",    value);}
+inline int format_value (char* buffer, const double        value) {return snprintf (buffer, 64, "%.16e",  value);}
+inline int format_value (char* buffer, const long double   value) {return snprintf (buffer, 64, "%.16Le", value);}
+
+
+///  Write a buffer to a file in one go
+///    @param[in] fname  : path to the file
+///    @param[in] buffer : contents of the file
+///    @return 0 on success, -1 otherwise
+/////////////////////////////////////////
+inline int write_buffer (const string &fname, const string &buffer)
+{
+    std::FILE* file = std::fopen (fname.c_str(), "wb");
+
+    if (file == nullptr) {return (-1);}
+
+    const size_t written = std::fwrite (buffer.data(), 1, buffer.size(), file);
+
+    std::fclose (file);
+
+    return (written == buffer.size()) ? 0 : -1;
+}
+
+
+///  Writer for a list of numbers, one per line
+///    @param[in] fname : path to the file
+///    @param[in] list  : list to be written
+///////////////////////////////////////////////
+template <class type>
+inline int write_values (const string &fname, const vector<type> &list)
+{
+    string buffer;
+    buffer.reserve (24*list.size());
+
+    char number[64];
+
+    for (const type &value : list)
+    {
+        buffer.append (number, format_value (number, value));
+        buffer.push_back ('\n');
+    }
+
+    return write_buffer (fname, buffer);
+}
+
+
+///  Writer for an array of numbers, one (tab separated) row per line
+///    @param[in] fname : path to the file
+///    @param[in] array : array to be written
+/////////////////////////////////////////////////////////////////////
+template <class type>
+inline int write_values (const string &fname, const vector<vector<type>> &array)
+{
+    string buffer;
+    buffer.reserve (24*array.size()*(array.size() > 0 ? array[0].size() : 0));
+
+    char number[64];
+
+    for (const vector<type> &row : array)
+    {
+        for (const type &value : row)
+        {
+            buffer.append (number, format_value (number, value));
+            buffer.push_back ('\t');
+        }
+
+        buffer.push_back ('\n');
+    }
+
+    return write_buffer (fname, buffer);
+}
+
+
+///  Reader for an array of numbers, one row per line
+///  If the array is not yet sized, its shape is inferred from the file.
+///    @param[in]  fname : path to the file
+///    @param[out] array : array to be read
+////////////////////////////////////////////////////////////////////////
+template <class type>
+inline int read_values (const string &fname, vector<vector<type>> &array)
+{
+    vector<type> values;
+
+    const int err = read_tokens (fname, values);
+
+    if (err != 0) {return err;}
+
+    if (array.size() == 0)
+    {
+        // Count the number of columns in the first line
+        Size ncols = 0;
+
+        std::ifstream file (fname);
+        string line, elem;
+        std::getline (file, line);
+        std::stringstream ss (line);
+        while (ss >> elem) {ncols++;}
+
+        if (ncols == 0) {return (0);}
+
+        array.resize (values.size() / ncols, vector<type> (ncols));
+    }
+
+    size_t index = 0;
+
+    for (vector<type> &row : array)
+    {
+        for (type &value : row)
+        {
+            if (index < values.size()) {value = values[index++];}
+        }
+    }
+
+    return (0);
+}
+
+
 ///  Reader for the length of a text file
 ///    @param[in]  file_name : path to file containing the data
 ///    @param[out] length    : length to be read
@@ -33,16 +538,7 @@ int IoText :: read_length (const string file_name, Size &length) const
 
   if (pathExist (fname + ".txt"))
   {
-    std::ifstream file (fname + ".txt");
-
-    string line;
-
-    while (std::getline (file, line))
-    {
-      length++;
-    }
-
-    file.close();
+    length = count_lines (fname + ".txt");
   }
 
   else
@@ -338,18 +834,7 @@ int IoText :: write_bool (const string file_name, const bool &value) const
 ///////////////////////////////////////////////////////////////
 int IoText :: read_list (const string file_name, Long1 &list) const
 {
-  std::ifstream file (io_file + file_name + ".txt");
-
-  long n = 0;
-
-  while (file >> list[n])
-  {
-    n++;
-  }
-
-  file.close();
-
-  return (0);
+    return read_tokens (io_file + file_name + ".txt", list);
 }
 
 
@@ -359,18 +844,7 @@ int IoText :: read_list (const string file_name, Long1 &list) const
 ////////////////////////////////////////////////////////
 int IoText :: write_list (const string file_name, const Long1 &list) const
 {
-  std::ofstream file (io_file + file_name + ".txt");
-
-  file << std::scientific << std::setprecision (16);
-
-  for (long n = 0; n < list.size(); n++)
-  {
-    file << list[n] << endl;
-  }
-
-  file.close();
-
-  return (0);
+    return write_values (io_file + file_name + ".txt", list);
 }
 
 
@@ -380,18 +854,7 @@ int IoText :: write_list (const string file_name, const Long1 &list) const
 //////////////////////////////////////////////////////////////
 int IoText :: read_list (const string file_name, Double1 &list) const
 {
-  std::ifstream file (io_file + file_name + ".txt");
-
-  long   n = 0;
-
-  while (file >> list[n])
-  {
-    n++;
-  }
-
-  file.close();
-
-  return (0);
+    return read_tokens (io_file + file_name + ".txt", list);
 }
 
 
@@ -401,18 +864,7 @@ int IoText :: read_list (const string file_name, Double1 &list) const
 ////////////////////////////////////////////////////////
 int IoText :: write_list (const string file_name, const Double1 &list) const
 {
-  std::ofstream file (io_file + file_name + ".txt");
-
-  file << std::scientific << std::setprecision (16);
-
-  for (long n = 0; n < list.size(); n++)
-  {
-    file << list[n] << endl;
-  }
-
-  file.close();
-
-  return (0);
+    return write_values (io_file + file_name + ".txt", list);
 }
 
 
@@ -422,18 +874,7 @@ int IoText :: write_list (const string file_name, const Double1 &list) const
 //////////////////////////////////////////////////////////////
 int IoText :: read_list (const string file_name, Size_t1 &list) const
 {
-    std::ifstream file (io_file + file_name + ".txt");
-
-    long   n = 0;
-
-    while (file >> list[n])
-    {
-        n++;
-    }
-
-    file.close();
-
-    return (0);
+    return read_tokens (io_file + file_name + ".txt", list);
 }
 
 
@@ -443,18 +884,7 @@ int IoText :: read_list (const string file_name, Size_t1 &list) const
 ////////////////////////////////////////////////////////
 int IoText :: write_list (const string file_name, const Size_t1 &list) const
 {
-    std::ofstream file (io_file + file_name + ".txt");
-
-    file << std::scientific << std::setprecision (16);
-
-    for (long n = 0; n < list.size(); n++)
-    {
-        file << list[n] << endl;
-    }
-
-    file.close();
-
-    return (0);
+    return write_values (io_file + file_name + ".txt", list);
 }
 
 
@@ -464,18 +894,7 @@ int IoText :: write_list (const string file_name, const Size_t1 &list) const
 //////////////////////////////////////////////////////////////
 int IoText :: read_list (const string file_name, Size1 &list) const
 {
-    std::ifstream file (io_file + file_name + ".txt");
-
-    long   n = 0;
-
-    while (file >> list[n])
-    {
-        n++;
-    }
-
-    file.close();
-
-    return (0);
+    return read_tokens (io_file + file_name + ".txt", list);
 }
 
 
@@ -485,18 +904,7 @@ int IoText :: read_list (const string file_name, Size1 &list) const
 ////////////////////////////////////////////////////////
 int IoText :: write_list (const string file_name, const Size1 &list) const
 {
-    std::ofstream file (io_file + file_name + ".txt");
-
-    file << std::scientific << std::setprecision (16);
-
-    for (long n = 0; n < list.size(); n++)
-    {
-        file << list[n] << endl;
-    }
-
-    file.close();
-
-    return (0);
+    return write_values (io_file + file_name + ".txt", list);
 }
 
 
@@ -506,18 +914,7 @@ int IoText :: write_list (const string file_name, const Size1 &list) const
 //////////////////////////////////////////////////////////////
 int IoText :: read_list (const string file_name, Real1 &list) const
 {
-    std::ifstream file (io_file + file_name + ".txt");
-
-    long   n = 0;
-
-    while (file >> list[n])
-    {
-        n++;
-    }
-
-    file.close();
-
-    return (0);
+    return read_tokens (io_file + file_name + ".txt", list);
 }
 
 
@@ -527,18 +924,7 @@ int IoText :: read_list (const string file_name, Real1 &list) const
 ////////////////////////////////////////////////////////
 int IoText :: write_list (const string file_name, const Real1 &list) const
 {
-    std::ofstream file (io_file + file_name + ".txt");
-
-    file << std::scientific << std::setprecision (16);
-
-    for (long n = 0; n < list.size(); n++)
-    {
-        file << list[n] << endl;
-    }
-
-    file.close();
-
-    return (0);
+    return write_values (io_file + file_name + ".txt", list);
 }
 
 
@@ -548,18 +934,7 @@ int IoText :: write_list (const string file_name, const Real1 &list) const
 //////////////////////////////////////////////////////////////
 int IoText :: read_list (const string file_name, String1 &list) const
 {
-  std::ifstream file (io_file + file_name + ".txt");
-
-  long   n = 0;
-
-  while (file >> list[n])
-  {
-    n++;
-  }
-
-  file.close();
-
-  return (0);
+    return read_tokens (io_file + file_name + ".txt", list);
 }
 
 
@@ -590,25 +965,7 @@ int IoText :: write_list (const string file_name, const String1 &list) const
 ///////////////////////////////////////////////////////////////
 int IoText :: read_array (const string file_name, Long2 &array) const
 {
-  std::ifstream file (io_file + file_name + ".txt");
-
-  string line;
-
-  for (long n1 = 0; n1 < array.size(); n1++)
-  {
-    std::getline (file, line);
-
-    std::stringstream ss (line);
-
-    for (long n2 = 0; n2 < array[n1].size(); n2++)
-    {
-      ss >> array[n1][n2];
-    }
-  }
-
-  file.close();
-
-  return (0);
+    return read_values (io_file + file_name + ".txt", array);
 }
 
 
@@ -618,23 +975,7 @@ int IoText :: read_array (const string file_name, Long2 &array) const
 ////////////////////////////////////////////////////////
 int IoText :: write_array (const string file_name, const Long2 &array) const
 {
-  std::ofstream file (io_file + file_name + ".txt");
-
-  file << std::scientific << std::setprecision (16);
-
-  for (long n1 = 0; n1 < array.size(); n1++)
-  {
-    for (long n2 = 0; n2 < array[n1].size(); n2++)
-    {
-      file << array[n1][n2] << "\t";
-    }
-
-    file << endl;
-  }
-
-  file.close();
-
-  return (0);
+    return write_values (io_file + file_name + ".txt", array);
 }
 
 
@@ -644,25 +985,7 @@ int IoText :: write_array (const string file_name, const Long2 &array) const
 ///////////////////////////////////////////////////////////////
 int IoText :: read_array (const string file_name, Double2 &array) const
 {
-  std::ifstream file (io_file + file_name + ".txt");
-
-  string line;
-
-  for (long n1 = 0; n1 < array.size(); n1++)
-  {
-    std::getline (file, line);
-
-    std::stringstream ss (line);
-
-    for (long n2 = 0; n2 < array[n1].size(); n2++)
-    {
-      ss >> array[n1][n2];
-    }
-  }
-
-  file.close();
-
-  return (0);
+    return read_values (io_file + file_name + ".txt", array);
 }
 
 
@@ -672,23 +995,7 @@ int IoText :: read_array (const string file_name, Double2 &array) const
 ////////////////////////////////////////////////////////
 int IoText :: write_array (const string file_name, const Double2 &array) const
 {
-  std::ofstream file (io_file + file_name + ".txt");
-
-  file << std::scientific << std::setprecision (16);
-
-  for (long n1 = 0; n1 < array.size(); n1++)
-  {
-    for (long n2 = 0; n2 < array[n1].size(); n2++)
-    {
-      file << array[n1][n2] << "\t";
-    }
-
-    file << endl;
-  }
-
-  file.close();
-
-  return (0);
+    return write_values (io_file + file_name + ".txt", array);
 }
 
 
@@ -698,25 +1005,7 @@ int IoText :: write_array (const string file_name, const Double2 &array) const
 ///////////////////////////////////////////////////////////////
 int IoText :: read_array (const string file_name, Real2 &array) const
 {
-    std::ifstream file (io_file + file_name + ".txt");
-
-    string line;
-
-    for (long n1 = 0; n1 < array.size(); n1++)
-    {
-        std::getline (file, line);
-
-        std::stringstream ss (line);
-
-        for (long n2 = 0; n2 < array[n1].size(); n2++)
-        {
-            ss >> array[n1][n2];
-        }
-    }
-
-    file.close();
-
-    return (0);
+    return read_values (io_file + file_name + ".txt", array);
 }
 
 
@@ -726,23 +1015,7 @@ int IoText :: read_array (const string file_name, Real2 &array) const
 ////////////////////////////////////////////////////////
 int IoText :: write_array (const string file_name, const Real2 &array) const
 {
-    std::ofstream file (io_file + file_name + ".txt");
-
-    file << std::scientific << std::setprecision (16);
-
-    for (long n1 = 0; n1 < array.size(); n1++)
-    {
-        for (long n2 = 0; n2 < array[n1].size(); n2++)
-        {
-            file << array[n1][n2] << "\t";
-        }
-
-        file << endl;
-    }
-
-    file.close();
-
-    return (0);
+    return write_values (io_file + file_name + ".txt", array);
 }
 
 
@@ -758,18 +1031,20 @@ int IoText :: read_3_vector (
               Double1 &y,
               Double1 &z         ) const
 {
-  std::ifstream file (io_file + file_name + ".txt");
+  Double1 values;
 
-  long   n = 0;
+  const int err = read_tokens (io_file + file_name + ".txt", values);
 
-  while (file >> x[n] >> y[n] >> z[n])
+  const size_t length = std::min (x.size(), values.size()/3);
+
+  for (size_t n = 0; n < length; n++)
   {
-    n++;
+    x[n] = values[3*n  ];
+    y[n] = values[3*n+1];
+    z[n] = values[3*n+2];
   }
 
-  file.close();
-
-  return (0);
+  return err;
 }
 
 
@@ -794,16 +1069,20 @@ int IoText :: write_3_vector (
     return (-1);
   }
 
-  std::ofstream file (io_file + file_name + ".txt");
+  string buffer;
+  buffer.reserve (72*length);
 
-  file << std::scientific << std::setprecision (16);
+  char number[64];
 
   for (long n = 0; n < length; n++)
   {
-    file << x[n] << "\t" << y[n] << "\t" << z[n] << endl;
+    buffer.append (number, format_value (number, x[n]));
+    buffer.push_back ('\t');
+    buffer.append (number, format_value (number, y[n]));
+    buffer.push_back ('\t');
+    buffer.append (number, format_value (number, z[n]));
+    buffer.push_back ('\n');
   }
 
-  file.close();
-
-  return (0);
+  return write_buffer (io_file + file_name + ".txt", buffer);
 }
@@ -0,0 +1,80 @@
+#pragma once
+
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "tools/types.hpp"
+
+
+///  MappedFile: read-only memory map of a file (private, copy-on-write)
+///  The mapped memory stays valid as long as the object exists, even if
+///  the file is replaced on disk in the mean time.
+////////////////////////////////////////////////////////////////////////
+struct MappedFile
+{
+    const char* data = nullptr;   ///< start of the mapped memory
+    size_t      size = 0;         ///< size of the mapped file (bytes)
+
+    MappedFile () {};
+   ~MappedFile () {close();};
+
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    inline bool open  (const string &path);
+    inline void close ();
+};
+
+
+///  Map a file into memory (closes a previous mapping)
+///    @param[in] path : path to the file
+///    @return true if the file could be mapped
+//////////////////////////////////////////////////////
+inline bool MappedFile :: open (const string &path)
+{
+    close();
+
+    const int fd = ::open (path.c_str(), O_RDONLY);
+
+    if (fd < 0) {return false;}
+
+    struct stat info;
+
+    if ((fstat (fd, &info) != 0) || (info.st_size == 0))
+    {
+        ::close (fd);
+        return false;
+    }
+
+    void* ptr = mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file
+    ::close (fd);
+
+    if (ptr == MAP_FAILED) {return false;}
+
+    // Data is mostly read front to back
+    madvise (ptr, info.st_size, MADV_SEQUENTIAL);
+
+    data = static_cast<const char*> (ptr);
+    size = info.st_size;
+
+    return true;
+}
+
+
+///  Unmap the file (if mapped)
+///////////////////////////////
+inline void MappedFile :: close ()
+{
+    if (data != nullptr)
+    {
+        munmap (const_cast<char*> (data), size);
+    }
+
+    data = nullptr;
+    size = 0;
+}
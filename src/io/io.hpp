@@ -14,6 +14,9 @@ struct Io
     // Constructor
     Io (const string &io_file): io_file (io_file) {};
 
+    // Destructor
+    virtual ~Io () = default;
+
     virtual int  read_length   (const string fname,       Size    &length) const = 0;
     virtual Size  get_length   (const string fname                       ) const = 0;
 
@@ -98,6 +101,41 @@ struct Io
     }
 
 
+    virtual int read_lists (const String1& fnames, const vector<Real1*>& lists) const
+    {
+        int err = 0;
+        for (Size i = 0; i < fnames.size(); i++)
+        {
+            if (read_list (fnames[i], *lists[i]) != 0) {err = -1;}
+        }
+        return err;
+    }
+
+
+    virtual int read_array (const string fname, Vector<Vector3D>& v) const
+    {
+        Double2 buffer (v.vec.size(), Double1 (3));
+        int err = read_array (fname, buffer);
+        for (Size p = 0; p < v.vec.size(); p++)
+        {
+            v.vec[p] = Vector3D (buffer[p][0], buffer[p][1], buffer[p][2]);
+        }
+        v.set_dat ();
+        return err;
+    }
+
+
+    virtual int write_array (const string fname, const Vector<Vector3D>& v) const
+    {
+        Double2 buffer (v.vec.size(), Double1 (3));
+        for (Size p = 0; p < v.vec.size(); p++)
+        {
+            buffer[p] = {v.vec[p].x(), v.vec[p].y(), v.vec[p].z()};
+        }
+        return write_array (fname, buffer);
+    }
+
+
     int read_array (const string fname, Matrix<Real>& v) const
     {
         int err = read_list (fname, v.vec);
@@ -1,3 +1,4 @@
+#include <map>
 #include <string>
 using std::string;
 
@@ -11,12 +12,84 @@ namespace py = pybind11;
 const string IoPython::io_folder = string (MAGRITTE_FOLDER) + "/src/io/python/";
 
 
+///  Cache for the imported python module and its functions
+///  If the module supports it, the io file is kept open as long as the
+///  cache exists (open_file / close_file), to avoid reopening it for every
+///  dataset. The module then returns a handle for the open file, which is
+///  passed to the io functions instead of the file name, such that every
+///  cache has its own open file (and the module keeps no global state).
+///////////////////////////////////////////////////////////////////////////
+struct IoPython :: Cache
+{
+    py::module                   module;      ///< imported io module
+    std::map<string, py::object> functions;   ///< functions used so far
+    py::object                   handle;      ///< open file (or file name) passed to the module
+
+    Cache (const string &implementation, const string &io_file)
+    {
+        if (!Py_IsInitialized()) {py::initialize_interpreter ();}
+
+        // Add /Io folder to Python path (once)
+        py::object path = py::module::import("sys").attr("path");
+
+        if (!path.attr("__contains__")(io_folder).cast<bool>())
+        {
+            path.attr("insert")(0, io_folder);
+        }
+
+        module = py::module::import (implementation.c_str());
+
+        if (py::hasattr (module, "open_file")) {handle = module.attr("open_file")(io_file);}
+        else                                   {handle = py::str (io_file);                }
+    }
+
+    ~Cache ()
+    {
+        try
+        {
+            if (py::hasattr (module, "close_file")) {module.attr("close_file")(handle);}
+        }
+        catch (...) {}
+    }
+
+    py::object& function (const string &name)
+    {
+        auto it = functions.find (name);
+
+        if (it == functions.end())
+        {
+            it = functions.emplace (name, py::object (module.attr (name.c_str()))).first;
+        }
+
+        return it->second;
+    }
+};
+
+
 ///  Constructor for IoPython
 ///    @param[in] implementaion : name of python module with io implementation
 ///    @param[in] io_file       : file to read from and write to
 //////////////////////////////////////////////////////////////////////////////
 IoPython :: IoPython (const string &imp, const string &io_file)
-  : Io (io_file), implementation ("io_python_" + imp) {}
+  : Io (io_file), implementation ("io_python_" + imp),
+    cache (std::make_shared<Cache> (implementation, io_file)) {}
+
+
+///  Flush the io file kept open by the module (if any) to disk
+/////////////////////////////////////////////////////////////
+void IoPython :: flush () const
+{
+    if (py::hasattr (cache->module, "flush_file")) {cache->function ("flush_file") (cache->handle);}
+}
+
+
+///  Close the io file kept open by the module (if any)
+///  It is reopened when the object is used again.
+//////////////////////////////////////////////////////
+void IoPython :: close () const
+{
+    if (py::hasattr (cache->module, "close_file")) {cache->function ("close_file") (cache->handle);}
+}
 
 
 ///  Reader for the length of a file
@@ -501,6 +574,39 @@ int IoPython :: write_3_vector (
 }
 
 
+///  Batched reader for lists of Reals, reading all datasets in a single
+///  python call (if the implementation supports it, i.e. has "read_arrays")
+///    @param[in]  file_names : paths to files containing the lists
+///    @param[out] lists      : pointers to the lists to be read
+//////////////////////////////////////////////////////////////////////////
+int IoPython :: read_lists (const String1& file_names, const vector<Real1*>& lists) const
+{
+    if (!py::hasattr (cache->module, "read_arrays"))
+    {
+        return Io::read_lists (file_names, lists);
+    }
+
+    int err = 0;
+
+    try
+    {
+        py::list result = cache->function ("read_arrays") (cache->handle, file_names).cast<py::list>();
+
+        for (Size i = 0; i < file_names.size(); i++)
+        {
+            if (result[i].is_none()) {err = -1;                         }
+            else                     {*lists[i] = result[i].cast<Real1>();}
+        }
+    }
+    catch (...)
+    {
+        err = -1;
+    }
+
+    return err;
+}
+
+
 ///  Executer in python for reader functions
 ///    @param[in]  function  : name of reader function to execute
 ///    @param[in]  file_name : name of the file from which to read
@@ -512,15 +618,8 @@ int IoPython :: read_in_python (
         const string  file_name,
               type   &data      ) const
 {
-    try         {py::initialize_interpreter ();}
-    catch (...) {                              }
-
-
-    // Add /Io folder to Python path
-    py::module::import("sys").attr("path").attr("insert")(0, io_folder);
-
-    // Import function defined in
-    py::object ioFunction = py::module::import(implementation.c_str()).attr(function.c_str());
+    // Get (cached) function defined in implementation file
+    py::object& ioFunction = cache->function (function);
 
     // Make a copy of data
     type data_copy = data;
@@ -530,7 +629,7 @@ int IoPython :: read_in_python (
     try
     {
         // Execute io function
-        py::object result = ioFunction (io_file, file_name);
+        py::object result = ioFunction (cache->handle, file_name);
 
         // Cast result to appropriate type
         data = result.cast<type>();
@@ -561,20 +660,14 @@ int IoPython :: write_in_python (
         const string  file_name,
         const type   &data      ) const
 {
-    try         {py::initialize_interpreter ();}
-    catch (...) {                              }
-
-    // Add /Io folder to Python path
-    py::module::import("sys").attr("path").attr("insert")(0, io_folder.c_str());
-
-    // Import function defined in implementation file
-    py::object ioFunction = py::module::import(implementation.c_str()).attr(function.c_str());
+    // Get (cached) function defined in implementation file
+    py::object& ioFunction = cache->function (function);
 
     bool success;
 
     // Execute io function
-    try         {ioFunction (io_file, file_name, data); success = true; }
-    catch (...) {                                       success = false;}
+    try         {ioFunction (cache->handle, file_name, data); success = true; }
+    catch (...) {                                             success = false;}
 
     if (success) return ( 0);
     else         return (-1);
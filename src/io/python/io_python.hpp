@@ -1,12 +1,17 @@
 #pragma once
 
 
+#include <memory>
+
 #include "io/io.hpp"
 #include "tools/types.hpp"
 
 
-///  IoText: io specified by text files
-///////////////////////////////////////
+///  IoPython: io through (embedded) python, e.g. for HDF5 files with h5py
+///  The imported module and its functions are cached in the object (and its
+///  copies), such that they are not re-imported for every dataset. The io
+///  file stays open until the last copy is destroyed, or until close().
+////////////////////////////////////////////////////////////////////////////
 
 struct IoPython : public Io
 {
@@ -16,6 +21,10 @@ struct IoPython : public Io
         // Constructor
         IoPython (const string &implementation, const string &io_file);
 
+        // The io file is kept open as long as the object (or a copy) exists
+        void flush () const;
+        void close () const;
+
         int  read_length   (const string fname,       Size    &length) const override;
         Size  get_length   (const string fname                       ) const override;
 
@@ -71,10 +80,15 @@ struct IoPython : public Io
                                                 const Double1 &y,
                                                 const Double1 &z     ) const override;
 
+        int  read_lists    (const String1& fnames, const vector<Real1*>& lists) const override;
+
 
     private:
         static const string io_folder;   ///< path to io_python files
 
+        struct Cache;                    ///< python module and functions (hides pybind11)
+        std::shared_ptr<Cache> cache;    ///< cache, shared between copies
+
         template <class type>
         int read_in_python  (
             const string function, const string file_name,        type &data) const;
@@ -1,12 +1,83 @@
 import numpy as np
 import h5py  as hp
 
+from contextlib import contextmanager
+
+
+class OpenFile:
+    """
+    Handle that keeps an io file open between calls, one for each IoPython
+    object (such that several files, or the same file, can be used at once).
+    The file is only actually opened on first use.
+    """
+    def __init__ (self, io_file):
+        self.io_file = io_file
+        self.file    = None
+
+    def get (self, mode):
+        """
+        Return the open file (reopened if it is required for writing).
+        """
+        if (self.file is None) or ((mode != 'r') and (self.file.mode == 'r')):
+            self.close()
+            self.file = hp.File (self.io_file, mode)
+        return self.file
+
+    def flush (self):
+        """
+        Write everything that was written so far to disk (keeps it open).
+        """
+        if self.file is not None:
+            self.file.flush()
+
+    def close (self):
+        """
+        Close the file (it is reopened on next use).
+        """
+        if self.file is not None:
+            self.file.close()
+            self.file = None
+
+
+def open_file (io_file):
+    """
+    Return a handle that keeps the file open until close_file is called.
+    """
+    return OpenFile (io_file)
+
+
+def flush_file (handle):
+    """
+    Flush the file kept open by the handle.
+    """
+    handle.flush()
+
+
+def close_file (handle):
+    """
+    Close the file kept open by the handle.
+    """
+    handle.close()
+
+
+@contextmanager
+def _file (io_file, mode):
+    """
+    Return the file kept open by the handle, or (if a file name is given)
+    open the file only for the duration of the with statement.
+    """
+    if isinstance (io_file, OpenFile):
+        yield io_file.get (mode)
+    else:
+        with hp.File (io_file, mode) as file:
+            yield file
+
 
 def read_length (io_file, file_name):
     """
     Return the number of lines in the input file.
     """
-    with hp.File (io_file, 'r') as file:
+    with _file (io_file, 'r') as file:
 
         # print('In the file? here are the keys:')
         # print(file.keys())
@@ -41,7 +112,7 @@ def read_width (io_file, file_name):
     """
     Return the number of columns in the input file.
     """
-    with hp.File (io_file, 'r') as file:
+    with _file (io_file, 'r') as file:
         try:
             # Try to open the object
             object = file [file_name]
@@ -67,7 +138,7 @@ def read_attribute (io_file, file_name):
     """
     Return the contents of the attribute
     """
-    with hp.File (io_file, 'r') as file:
+    with _file (io_file, 'r') as file:
         object    = file_name.split('.')[0]
         attribute = file_name.split('.')[1]
         if object != '':
@@ -80,7 +151,7 @@ def write_attribute (io_file, file_name, data):
     """
     Write the data to the attribute
     """
-    with hp.File (io_file, 'a') as file:
+    with _file (io_file, 'a') as file:
         object    = file_name.split('.')[0]
         attribute = file_name.split('.')[1]
         # Make sure all groups exists, if not create them
@@ -120,16 +191,26 @@ def read_array (io_file, file_name):
     """
     Return the contents of the data array.
     """
-    with hp.File (io_file, 'r') as file:
+    with _file (io_file, 'r') as file:
         if (file_name in file):
             return np.array (file.get (file_name))
 
 
+def read_arrays (io_file, file_names):
+    """
+    Return the contents of several data arrays (None if missing),
+    reading all of them from the same open file.
+    """
+    with _file (io_file, 'r') as file:
+        return [np.array (file.get (name)) if (name in file) else None
+                for name in file_names]
+
+
 def write_array (io_file, file_name, data):
     """
     Write the contents to the data array.
     """
-    with hp.File (io_file, 'a') as file:
+    with _file (io_file, 'a') as file:
         # print ('Writing array to HDF5 file...')
         # print (io_file, file_name)
         # Delete if dataset already exists
@@ -15,4 +15,14 @@ struct Chemistry
 
     void read  (const Io& io);
     void write (const Io& io) const;
+
+    ///  Set the parameters of the chemistry and its species
+    ///    @param[in] params : parameters of the model
+    ////////////////////////////////////////////////////////
+    inline void set_parameters (const Parameters& params)
+    {
+        parameters = params;
+
+        species.parameters = params;
+    }
 };
@@ -1,3 +1,5 @@
+#include <Eigen/Dense>
+
 #include "geometry.hpp"
 
 
@@ -7,7 +9,8 @@ void Geometry :: read (const Io& io)
     rays    .read (io);
     boundary.read (io);
 
-    lengths.resize (parameters.hnrays(), parameters.npoints());
+    lengths      .resize (parameters.hnrays(), parameters.npoints());
+    lengths_first.resize (parameters.hnrays(), parameters.npoints());
 }
 
 
@@ -17,3 +20,108 @@ void Geometry :: write (const Io& io) const
     rays    .write (io);
     boundary.write (io);
 }
+
+
+///  Build a hierarchy of coarsened grids (boundary points are always kept)
+///    @param[in] n_levels : requested number of coarser levels
+///    @return number of coarser levels that could actually be created
+//////////////////////////////////////////////////////////////////////////
+Size Geometry :: coarsen (const Size n_levels)
+{
+    if (parameters.spherical_symmetry())
+    {
+        throw std::runtime_error ("Coarsening is not supported in spherical symmetry.");
+    }
+
+    cout << "Coarsening grid..." << endl;
+
+    // Make sure the hierarchy is built from the original neighbour lists
+    if (points.multiscale.get_n_levels() > 0) {set_coarsening_level (0);}
+
+    points.multiscale.initialize (points.n_neighbors, points.neighbors);
+
+    Bool1 keep (parameters.npoints());
+
+    for (Size p = 0; p < parameters.npoints(); p++)
+    {
+        keep[p] = !not_on_boundary (p);
+    }
+
+    Size lvl = 0;
+
+    while ((lvl < n_levels) && points.multiscale.coarsen (keep))
+    {
+        lvl++;
+
+        cout << "  level " << lvl << " : "
+             << points.multiscale.get_n_points (lvl) << " points" << endl;
+    }
+
+    return lvl;
+}
+
+
+///  Setter for the coarsening level used in ray tracing
+///    @param[in] lvl : coarsening level (0 is the original grid)
+///////////////////////////////////////////////////////////////
+void Geometry :: set_coarsening_level (const Size lvl)
+{
+    points.set_coarsening_level (lvl);
+}
+
+
+///  Getter for the local velocity gradient tensor, G(i,j) = d v_i / d x_j,
+///  estimated from the neighbours of a point. In spherical symmetry this is
+///  diag (dv/dr, v/r, v/r) such that, for a ray direction n = (cos, sin, 0),
+///  the velocity gradient along the ray is n^T G n in both cases.
+///    @param[in] p : index of the point
+///    @return velocity gradient tensor at point p
+/////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix3d Geometry :: get_velocity_gradient (const Size p) const
+{
+    Eigen::Matrix3d gradient = Eigen::Matrix3d::Zero();
+
+    if (parameters.spherical_symmetry())
+    {
+        const Size p1 = (p == 0                     ) ? p : p-1;
+        const Size p2 = (p == parameters.npoints()-1) ? p : p+1;
+
+        const double dr = points.position[p2].x() - points.position[p1].x();
+        const double r  = points.position[p ].x();
+
+        if (dr > 0.0)
+        {
+            gradient(0,0) = (points.velocity[p2].x() - points.velocity[p1].x()) / dr;
+        }
+
+        gradient(1,1) = (r > 0.0) ? points.velocity[p].x() / r : gradient(0,0);
+        gradient(2,2) = gradient(1,1);
+    }
+    else
+    {
+        // Least squares fit of  dv = G dx  over all neighbours
+        Eigen::Matrix3d xx = Eigen::Matrix3d::Zero();
+        Eigen::Matrix3d vx = Eigen::Matrix3d::Zero();
+
+        const Size     n_nbs = points.    n_neighbors[p];
+        const Size cum_n_nbs = points.cum_n_neighbors[p];
+
+        for (Size i = 0; i < n_nbs; i++)
+        {
+            const Size     n  = points.neighbors[cum_n_nbs+i];
+            const Vector3D dx = points.position[n] - points.position[p];
+            const Vector3D dv = points.velocity[n] - points.velocity[p];
+
+            const Eigen::Vector3d ex (dx.x(), dx.y(), dx.z());
+            const Eigen::Vector3d ev (dv.x(), dv.y(), dv.z());
+
+            xx += ex * ex.transpose();
+            vx += ev * ex.transpose();
+        }
+
+        // Pseudo-inverse, to allow for 1D and 2D (degenerate) configurations
+        gradient = vx * xx.completeOrthogonalDecomposition().pseudoInverse();
+    }
+
+    return gradient;
+}
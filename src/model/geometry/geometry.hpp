@@ -14,6 +14,16 @@
 enum Frame {CoMoving, Rest};
 
 
+///  Kind of geometry, determines how rays are traced through the points
+////////////////////////////////////////////////////////////////////////
+enum GeometryType {GeneralGeometry, SphericalSymmetry};
+
+
+///  Number of neighbours that are evaluated together in the neighbour scan
+///////////////////////////////////////////////////////////////////////////
+const Size n_simd_lanes = 4;
+
+
 ///  Data structure for geometry
 ////////////////////////////////
 struct Geometry
@@ -24,11 +34,41 @@ struct Geometry
     Boundary   boundary;     ///< data structure containing boundary data
 
     Matrix<Size> lengths;
+    Matrix<Size> lengths_first;     ///< part of the ray pair lengths along rr (before the centre)
     Size         lengths_max;
+    Size         lengths_lvl = 0;   ///< coarsening level for which the lengths were computed
+    const void*  lengths_for = 0;   ///< model (or ensemble) for which the lengths were computed
 
     void read  (const Io& io);
     void write (const Io& io) const;
 
+    ///  Set the parameters of the geometry and its parts
+    ///    @param[in] params : parameters of the model
+    /////////////////////////////////////////////////////
+    inline void set_parameters (const Parameters& params)
+    {
+        parameters = params;
+
+        points  .set_parameters (params);
+        rays    .parameters = params;
+        boundary.parameters = params;
+    }
+
+    Size coarsen              (const Size n_levels);
+    void set_coarsening_level (const Size lvl);
+
+    Eigen::Matrix3d get_velocity_gradient (const Size p) const;
+
+    accel inline GeometryType get_geometry_type () const;
+
+    template <GeometryType geometry_type>
+    accel inline Size get_next (
+        const Size    o,
+        const Size    r,
+        const Size    crt,
+              double& Z,
+              double& dZ  ) const;
+
     accel inline void get_next (
         const Size    o,
         const Size    r,
@@ -59,6 +99,13 @@ struct Geometry
               double& Z,
               double& dZ  ) const;
 
+    template <Frame frame, GeometryType geometry_type>
+    accel inline double get_shift (
+        const Size   o,
+        const Size   r,
+        const Size   crt,
+        const double Z   ) const;
+
     template <Frame frame>
     accel inline double get_shift (
         const Size   o,
@@ -84,6 +131,12 @@ struct Geometry
         const double shift_nxt,
         const double dshift_max ) const;
 
+    template <Frame frame, GeometryType geometry_type>
+    accel inline Size get_ray_length (
+        const Size   o,
+        const Size   r,
+        const double dshift_max ) const;
+
     template <Frame frame>
     accel inline Size get_ray_length (
         const Size   o,
@@ -21,26 +21,50 @@ accel inline Size Geometry :: get_next_general_geometry (
     const Size     n_nbs = points.    n_neighbors[c];
     const Size cum_n_nbs = points.cum_n_neighbors[c];
 
+    const double ox = points.x[o];
+    const double oy = points.y[o];
+    const double oz = points.z[o];
+
+    const double dx = rays.direction[r].x();
+    const double dy = rays.direction[r].y();
+    const double dz = rays.direction[r].z();
+
     double dmin = std::numeric_limits<Real>::max();   // Initialize to "infinity"
     Size   next = parameters.npoints();               // return npoints when there is no next
 
-//    for (Size i = 0; i < nnbs; i++)
-    for (Size i = 0; i < n_nbs; i++)
+    // Evaluate the neighbours in blocks of n_simd_lanes, padding the last
+    // block with the last neighbour (which can never be selected twice)
+    for (Size i0 = 0; i0 < n_nbs; i0 += n_simd_lanes)
     {
-//        const Size     n     = points.nbs[c*nnbs+i];
-        const Size     n     = points.neighbors[cum_n_nbs+i];
-        const Vector3D R     = points.position[n] - points.position[o];
-        const double   Z_new = R.dot(rays.direction[r]);
+        Size   n    [n_simd_lanes];
+        double Z_new[n_simd_lanes];
+        double dist2[n_simd_lanes];
+
+        for (Size lane = 0; lane < n_simd_lanes; lane++)
+        {
+            const Size i = (i0+lane < n_nbs) ? i0+lane : n_nbs-1;
+            n[lane] = points.neighbors[cum_n_nbs+i];
+        }
 
-        if (Z_new > Z)
+        // Independent across lanes, hence vectorisable
+        for (Size lane = 0; lane < n_simd_lanes; lane++)
         {
-            const double distance_from_ray2 = R.dot(R) - Z_new*Z_new;
+            const double Rx = points.x[n[lane]] - ox;
+            const double Ry = points.y[n[lane]] - oy;
+            const double Rz = points.z[n[lane]] - oz;
 
-            if (distance_from_ray2 < dmin)
+            Z_new[lane] = Rx*dx + Ry*dy + Rz*dz;
+            dist2[lane] = Rx*Rx + Ry*Ry + Rz*Rz - Z_new[lane]*Z_new[lane];
+        }
+
+        // Select in the original order, such that ties are resolved as before
+        for (Size lane = 0; lane < n_simd_lanes; lane++)
+        {
+            if ((Z_new[lane] > Z) && (dist2[lane] < dmin))
             {
-                dmin = distance_from_ray2;
-                next = n;
-                dZ   = Z_new - Z;   // such that dZ > 0.0
+                dmin = dist2[lane];
+                next = n[lane];
+                dZ   = Z_new[lane] - Z;   // such that dZ > 0.0
             }
         }
     }
@@ -126,7 +150,9 @@ inline double Geometry :: get_shift_general_geometry <CoMoving> (
     const Size  r,
     const Size  crt ) const
 {
-    return 1.0 - (points.velocity[crt] - points.velocity[o]).dot(rays.direction[r]);
+    return 1.0 - (  (points.vx[crt] - points.vx[o]) * rays.direction[r].x()
+                  + (points.vy[crt] - points.vy[o]) * rays.direction[r].y()
+                  + (points.vz[crt] - points.vz[o]) * rays.direction[r].z() );
 }
 
 
@@ -166,7 +192,13 @@ accel inline Size Geometry :: get_n_interpl (
 
 
 
-template <Frame frame>
+///  Getter for the number of points on a ray (including interpolated ones)
+///    @param[in] o          : number of cell from which the ray originates
+///    @param[in] r          : number of the ray along which we are looking
+///    @param[in] dshift_max : maximum allowed shift between points on the ray
+///    @return number of points on the ray
+/////////////////////////////////////////////////////////////////////////////
+template <Frame frame, GeometryType geometry_type>
 accel inline Size Geometry :: get_ray_length (
     const Size   o,
     const Size   r,
@@ -176,13 +208,13 @@ accel inline Size Geometry :: get_ray_length (
     double  Z = 0.0;   // distance from origin (o)
     double dZ = 0.0;   // last increment in Z
 
-    Size nxt = get_next (o, r, o, Z, dZ);
+    Size nxt = get_next <geometry_type> (o, r, o, Z, dZ);
 
     if (valid_point(nxt))
     {
         Size         crt = o;
-        double shift_crt = get_shift <frame> (o, r, crt, Z);
-        double shift_nxt = get_shift <frame> (o, r, nxt, Z);
+        double shift_crt = get_shift <frame, geometry_type> (o, r, crt, 0.0);   // as in the solver
+        double shift_nxt = get_shift <frame, geometry_type> (o, r, nxt, Z  );
 
         l += get_n_interpl (shift_crt, shift_nxt, dshift_max);
 
@@ -191,8 +223,8 @@ accel inline Size Geometry :: get_ray_length (
                   crt =       nxt;
             shift_crt = shift_nxt;
 
-                  nxt = get_next          (o, r, nxt, Z, dZ);
-            shift_nxt = get_shift <frame> (o, r, nxt, Z    );
+                  nxt = get_next  <geometry_type>        (o, r, nxt, Z, dZ);
+            shift_nxt = get_shift <frame, geometry_type> (o, r, nxt, Z    );
 
             l += get_n_interpl (shift_crt, shift_nxt, dshift_max);
 
@@ -207,6 +239,29 @@ accel inline Size Geometry :: get_ray_length (
 }
 
 
+///  Getter for the number of points on a ray (dispatching on the geometry type)
+///    @param[in] o          : number of cell from which the ray originates
+///    @param[in] r          : number of the ray along which we are looking
+///    @param[in] dshift_max : maximum allowed shift between points on the ray
+///    @return number of points on the ray
+/////////////////////////////////////////////////////////////////////////////////
+template <Frame frame>
+accel inline Size Geometry :: get_ray_length (
+    const Size   o,
+    const Size   r,
+    const double dshift_max                  ) const
+{
+    if (parameters.spherical_symmetry())
+    {
+        return get_ray_length <frame, SphericalSymmetry> (o, r, dshift_max);
+    }
+    else
+    {
+        return get_ray_length <frame, GeneralGeometry>   (o, r, dshift_max);
+    }
+}
+
+
 // inline Size1 Geometry :: get_ray_lengths ()
 // {
 //     for (Size rr = 0; rr < parameters.hnrays(); rr++)
@@ -285,18 +340,42 @@ accel inline Size Geometry :: get_next (
           double& Z,
           double& dZ                   ) const
 {
-    Size next;
-
     if (parameters.spherical_symmetry())
     {
-        next = get_next_spherical_symmetry (o, r, crt, Z, dZ);
+        return get_next <SphericalSymmetry> (o, r, crt, Z, dZ);
     }
     else
     {
-        next = get_next_general_geometry   (o, r, crt, Z, dZ);
+        return get_next <GeneralGeometry>   (o, r, crt, Z, dZ);
     }
+}
 
-    return next;
+
+///  Getter for the number of the next cell on ray and its distance along ray,
+///  for a geometry type that is known at compile time
+///    @param[in]      o : number of cell from which the ray originates
+///    @param[in]      r : number of the ray along which we are looking
+///    @param[in]      c : number of the cell put last on the ray
+///    @param[in/out]  Z : reference to the current distance along the ray
+///    @param[out]    dZ : reference to the distance increment to the next ray
+///    @return number of the next cell on the ray after the current cell
+///////////////////////////////////////////////////////////////////////////////////
+template <GeometryType geometry_type>
+accel inline Size Geometry :: get_next (
+    const Size    o,
+    const Size    r,
+    const Size    crt,
+          double& Z,
+          double& dZ                   ) const
+{
+    if (geometry_type == SphericalSymmetry)
+    {
+        return get_next_spherical_symmetry (o, r, crt, Z, dZ);
+    }
+    else
+    {
+        return get_next_general_geometry   (o, r, crt, Z, dZ);
+    }
 }
 
 
@@ -422,6 +501,32 @@ inline double Geometry :: get_shift (
     const double Z ) const
 {
     if (parameters.spherical_symmetry())
+    {
+        return get_shift <frame, SphericalSymmetry> (o, r, c, Z);
+    }
+    else
+    {
+        return get_shift <frame, GeneralGeometry>   (o, r, c, Z);
+    }
+}
+
+
+///  Getter for the doppler shift along the ray between the current cell and the
+///  origin, for a geometry type that is known at compile time
+///    @param[in] o   : number of cell from which the ray originates
+///    @param[in] r   : number of the ray along which we are looking
+///    @param[in] crt : number of the cell for which we want the velocity
+///    @param[in] Z   : reference to the current distance along the ray
+///    @return doppler shift along the ray between the current cell and the origin
+///////////////////////////////////////////////////////////////////////////////////////
+template<Frame frame, GeometryType geometry_type>
+inline double Geometry :: get_shift (
+    const Size   o,
+    const Size   r,
+    const Size   c,
+    const double Z ) const
+{
+    if (geometry_type == SphericalSymmetry)
     {
         return get_shift_spherical_symmetry <frame> (o, r, c, Z);
     }
@@ -430,3 +535,14 @@ inline double Geometry :: get_shift (
         return get_shift_general_geometry <frame> (o, r, c);
     }
 }
+
+
+///  Getter for the type of geometry of the model
+///    @return spherical symmetry or general geometry
+/////////////////////////////////////////////////////
+accel inline GeometryType Geometry :: get_geometry_type () const
+{
+    if (parameters.spherical_symmetry()) {return SphericalSymmetry;}
+    else                                 {return GeneralGeometry;  }
+}
+
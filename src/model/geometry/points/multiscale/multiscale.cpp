@@ -0,0 +1,157 @@
+#include "multiscale.hpp"
+
+
+///  Initialize the hierarchy with the original (finest) grid
+///    @param[in] n_nbs : number of neighbours of each point
+///    @param[in] nbs   : (flattened) neighbour lists of all points
+/////////////////////////////////////////////////////////////////////////
+void Multiscale :: initialize (
+    const Vector<Size>& n_nbs,
+    const Vector<Size>& nbs   )
+{
+    mask     .clear ();
+    neighbors.clear ();
+
+    mask.push_back (Bool1 (parameters.npoints(), true));
+
+    Size2 nbs_0 (parameters.npoints());
+
+    Size index = 0;
+
+    for (Size p = 0; p < parameters.npoints(); p++)
+    {
+        nbs_0[p].resize (n_nbs[p]);
+
+        for (Size i = 0; i < n_nbs[p]; i++)
+        {
+            nbs_0[p][i] = nbs[index];
+            index++;
+        }
+    }
+
+    neighbors.push_back (nbs_0);
+
+    curr_lvl = 0;
+}
+
+
+///  Add a coarser level to the hierarchy, by greedily removing an independent
+///  set of points from the current coarsest level. Points that have to be kept
+///  (e.g. the boundary) are never removed. Every removed point is guaranteed
+///  to have a neighbour in the new level, which is used for the prolongation.
+///    @param[in] keep : keep[p] is true if point p can never be removed
+///    @return true if a coarser level was created, false if nothing changed
+///////////////////////////////////////////////////////////////////////////////
+bool Multiscale :: coarsen (const Bool1& keep)
+{
+    const Bool1& mask_f = mask     .back();
+    const Size2& nbs_f  = neighbors.back();
+
+    Bool1 mask_c = mask_f;
+
+    // First let the points that have to be kept remove their neighbours,
+    // then do the same, in order, for all remaining points in the level.
+    for (Size pass = 0; pass < 2; pass++)
+    {
+        for (Size p = 0; p < parameters.npoints(); p++)
+        {
+            if (mask_c[p] && (keep[p] == (pass == 0)))
+            {
+                for (const Size n : nbs_f[p])
+                {
+                    if (!keep[n]) {mask_c[n] = false;}
+                }
+            }
+        }
+    }
+
+    if (mask_c == mask_f)
+    {
+        return false;
+    }
+
+    // Neighbours in the coarse level are the remaining neighbours and the
+    // remaining neighbours of the removed neighbours (second ring).
+    Size2 nbs_c (parameters.npoints());
+
+    threaded_for (p, parameters.npoints(),
+    {
+        if (mask_c[p])
+        {
+            for (const Size n : nbs_f[p])
+            {
+                if (mask_c[n])
+                {
+                    nbs_c[p].push_back (n);
+                }
+                else
+                {
+                    for (const Size m : nbs_f[n])
+                    {
+                        if (mask_c[m] && (m != p)) {nbs_c[p].push_back (m);}
+                    }
+                }
+            }
+
+            std::sort (nbs_c[p].begin(), nbs_c[p].end());
+
+            nbs_c[p].erase (std::unique (nbs_c[p].begin(), nbs_c[p].end()), nbs_c[p].end());
+        }
+    })
+
+    mask     .push_back (mask_c);
+    neighbors.push_back (nbs_c );
+
+    return true;
+}
+
+
+///  Prolongate values from a coarse level to all finer levels, by inverse
+///  distance weighting of the neighbours that are in the next coarser level.
+///  The values in the points of the coarse level itself are left untouched.
+///    @param[in]     lvl      : coarse level from which to prolongate
+///    @param[in]     position : positions of the points
+///    @param[in]     nvals    : number of values per point (stride)
+///    @param[in,out] values   : values, indexed as i + p*nvals
+//////////////////////////////////////////////////////////////////////////////
+void Multiscale :: prolongate (
+    const Size              lvl,
+    const Vector<Vector3D>& position,
+    const Size              nvals,
+          VectorXr&         values   ) const
+{
+    for (Size l = lvl; l > 0; l--)
+    {
+        const Bool1& mask_c = mask     [l  ];
+        const Bool1& mask_f = mask     [l-1];
+        const Size2& nbs_f  = neighbors[l-1];
+
+        threaded_for (p, parameters.npoints(),
+        {
+            if (mask_f[p] && !mask_c[p])
+            {
+                Real weight_tot = 0.0;
+
+                for (Size i = 0; i < nvals; i++) {values[i+p*nvals] = 0.0;}
+
+                for (const Size n : nbs_f[p])
+                {
+                    if (mask_c[n])
+                    {
+                        const Vector3D R = position[n] - position[p];
+                        const Real     w = 1.0 / sqrt (R.squaredNorm());
+
+                        for (Size i = 0; i < nvals; i++)
+                        {
+                            values[i+p*nvals] += w * values[i+n*nvals];
+                        }
+
+                        weight_tot += w;
+                    }
+                }
+
+                for (Size i = 0; i < nvals; i++) {values[i+p*nvals] /= weight_tot;}
+            }
+        })
+    }
+}
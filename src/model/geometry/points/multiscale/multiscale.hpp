@@ -0,0 +1,40 @@
+#pragma once
+
+
+#include "model/parameters/parameters.hpp"
+#include "tools/types.hpp"
+
+
+///  Multiscale: hierarchy of coarsened point sets and their neighbour lists
+///  Level 0 is the original (finest) grid, every next level is a subset of
+///  the previous one, obtained by removing an independent set of points.
+///////////////////////////////////////////////////////////////////////////
+struct Multiscale
+{
+    Parameters parameters;      ///< data structure containing model parameters
+
+    vector<Bool1> mask;         ///< mask[lvl][p] is true if point p is in level lvl
+    vector<Size2> neighbors;    ///< neighbors[lvl][p] neighbours of point p in level lvl
+
+    Size curr_lvl = 0;          ///< current coarsening level
+
+    void initialize (
+        const Vector<Size>& n_nbs,
+        const Vector<Size>& nbs   );
+
+    bool coarsen (const Bool1& keep);
+
+    void prolongate (
+        const Size              lvl,
+        const Vector<Vector3D>& position,
+        const Size              nvals,
+              VectorXr&         values   ) const;
+
+    inline Size get_n_levels () const;
+    inline Size get_n_points (const Size lvl) const;
+    inline bool in_grid      (const Size p) const;
+    inline Bool1 get_mask    () const;
+};
+
+
+#include "multiscale.tpp"
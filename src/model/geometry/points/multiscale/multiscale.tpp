@@ -0,0 +1,42 @@
+#include <algorithm>
+
+
+///  Getter for the number of coarsening levels
+///    @return number of levels in the hierarchy (at least 1 once initialized)
+//////////////////////////////////////////////////////////////////////////////
+inline Size Multiscale :: get_n_levels () const
+{
+    return mask.size();
+}
+
+
+///  Getter for the number of points in a coarsening level
+///    @param[in] lvl : coarsening level
+///    @return number of points in that level
+//////////////////////////////////////////////////////////
+inline Size Multiscale :: get_n_points (const Size lvl) const
+{
+    return std::count (mask[lvl].begin(), mask[lvl].end(), true);
+}
+
+
+///  Check whether a point is part of the current coarsening level
+///    @param[in] p : point index
+///    @return true if p is in the current grid (always true without hierarchy)
+///////////////////////////////////////////////////////////////////////////////
+inline bool Multiscale :: in_grid (const Size p) const
+{
+    return (curr_lvl == 0) || mask[curr_lvl][p];
+}
+
+
+///  Getter for the mask of the current coarsening level
+///    @return mask of the current grid (empty on the finest level, where all
+///            points are part of the grid)
+//////////////////////////////////////////////////////////////////////////////
+inline Bool1 Multiscale :: get_mask () const
+{
+    if (curr_lvl == 0) {return Bool1 ();}
+
+    return mask[curr_lvl];
+}
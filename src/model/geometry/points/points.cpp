@@ -15,22 +15,8 @@ void Points :: read (const Io& io)
     position.resize (parameters.npoints());
     velocity.resize (parameters.npoints());
 
-    Double2 position_buffer (parameters.npoints(), Double1(3));
-    Double2 velocity_buffer (parameters.npoints(), Double1(3));
-
-    io.read_array (prefix+"position", position_buffer);
-    io.read_array (prefix+"velocity", velocity_buffer);
-
-    for (Size p = 0; p < parameters.npoints(); p++)
-    {
-        position[p] = Vector3D (position_buffer[p][0],
-                                position_buffer[p][1],
-                                position_buffer[p][2] );
-
-        velocity[p] = Vector3D (velocity_buffer[p][0],
-                                velocity_buffer[p][1],
-                                velocity_buffer[p][2] );
-    }
+    io.read_array (prefix+"position", position);
+    io.read_array (prefix+"velocity", velocity);
 
     parameters.set_totnnbs (io.get_length (prefix+"neighbors"));
 
@@ -52,6 +38,8 @@ void Points :: read (const Io& io)
     position.copy_vec_to_ptr ();
     velocity.copy_vec_to_ptr ();
 
+    set_components ();
+
     cum_n_neighbors.copy_vec_to_ptr ();
         n_neighbors.copy_vec_to_ptr ();
           neighbors.copy_vec_to_ptr ();
@@ -80,22 +68,88 @@ void Points :: read (const Io& io)
 
 void Points :: write (const Io& io) const
 {
-    Double2 position_buffer (parameters.npoints(), Double1(3));
-    Double2 velocity_buffer (parameters.npoints(), Double1(3));
+    io.write_array (prefix+"position", position);
+    io.write_array (prefix+"velocity", velocity);
+
+    io.write_list (prefix+"n_neighbors", n_neighbors);
+    io.write_list (prefix+  "neighbors",   neighbors);
+}
+
 
-    for (size_t p = 0; p < parameters.npoints(); p++)
+///  Setter for the coarsening level, replaces the neighbour lists used in
+///  the ray tracer by those of the given level in the multiscale hierarchy.
+///  Points that are not in the level get no neighbours.
+///    @param[in] lvl : coarsening level (0 is the original grid)
+///////////////////////////////////////////////////////////////////////////
+void Points :: set_coarsening_level (const Size lvl)
+{
+    if (lvl >= multiscale.get_n_levels())
     {
-        position_buffer[p] = {position[p].x(),
-                              position[p].y(),
-                              position[p].z() };
-        velocity_buffer[p] = {velocity[p].x(),
-                              velocity[p].y(),
-                              velocity[p].z() };
+        throw std::runtime_error ("Coarsening level does not exist.");
     }
 
-    io.write_array (prefix+"position", position_buffer);
-    io.write_array (prefix+"velocity", velocity_buffer);
+    const Size2& nbs = multiscale.neighbors[lvl];
 
-    io.write_list (prefix+"n_neighbors", n_neighbors);
-    io.write_list (prefix+  "neighbors",   neighbors);
+    Size totnnbs = 0;
+
+    for (Size p = 0; p < parameters.npoints(); p++)
+    {
+        n_neighbors[p] = nbs[p].size();
+        totnnbs       += nbs[p].size();
+    }
+
+    neighbors.resize (totnnbs);
+
+    cum_n_neighbors[0] = 0;
+
+    for (Size p = 1; p < parameters.npoints(); p++)
+    {
+        cum_n_neighbors[p] = cum_n_neighbors[p-1] + n_neighbors[p-1];
+    }
+
+    threaded_for (p, parameters.npoints(),
+    {
+        for (Size i = 0; i < nbs[p].size(); i++)
+        {
+            neighbors[cum_n_neighbors[p]+i] = nbs[p][i];
+        }
+    })
+
+    cum_n_neighbors.copy_vec_to_ptr ();
+        n_neighbors.copy_vec_to_ptr ();
+          neighbors.copy_vec_to_ptr ();
+
+    multiscale.curr_lvl = lvl;
+}
+
+
+///  Setter for the separate components of the positions and velocities,
+///  such that the ray tracer can evaluate several neighbours at once.
+///  Should be called whenever position or velocity changed.
+////////////////////////////////////////////////////////////////////////
+void Points :: set_components ()
+{
+    x .resize (parameters.npoints());
+    y .resize (parameters.npoints());
+    z .resize (parameters.npoints());
+    vx.resize (parameters.npoints());
+    vy.resize (parameters.npoints());
+    vz.resize (parameters.npoints());
+
+    threaded_for (p, parameters.npoints(),
+    {
+        x [p] = position[p].x();
+        y [p] = position[p].y();
+        z [p] = position[p].z();
+        vx[p] = velocity[p].x();
+        vy[p] = velocity[p].y();
+        vz[p] = velocity[p].z();
+    })
+
+    x .copy_vec_to_ptr ();
+    y .copy_vec_to_ptr ();
+    z .copy_vec_to_ptr ();
+    vx.copy_vec_to_ptr ();
+    vy.copy_vec_to_ptr ();
+    vz.copy_vec_to_ptr ();
 }
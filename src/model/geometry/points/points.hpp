@@ -4,6 +4,7 @@
 #include "io/io.hpp"
 #include "model/parameters/parameters.hpp"
 #include "tools/types.hpp"
+#include "multiscale/multiscale.hpp"
 
 // const Size nnbs = 12;
 
@@ -14,15 +15,33 @@ struct Points
     Vector <Vector3D> position;          ///< position vectors of each point
     Vector <Vector3D> velocity;          ///< velocity vectors of each point
 
+    Vector <double>   x,  y,  z;         ///< components of the positions (structure of arrays)
+    Vector <double>   vx, vy, vz;        ///< components of the velocities (structure of arrays)
+
     Vector <Size>     cum_n_neighbors;   ///< cumulative number of neighbors
     Vector <Size>         n_neighbors;   ///< number of neighbors
     Vector <Size>           neighbors;   ///< neighbors of each point
 
     // Vector <Size> nbs;
 
+    Multiscale multiscale;               ///< hierarchy of coarsened grids (for multigrid)
+
     void read  (const Io& io);
     void write (const Io& io) const;
 
+    ///  Set the parameters of the points (and their multiscale grids)
+    ///    @param[in] params : parameters of the model
+    //////////////////////////////////////////////////////////////////
+    inline void set_parameters (const Parameters& params)
+    {
+        parameters = params;
+
+        multiscale.parameters = params;
+    }
+
+    void set_coarsening_level (const Size lvl);
+    void set_components       ();
+
     void print()
     {
         for (Size r = 0; r < 10; r++)
@@ -15,17 +15,8 @@ void Rays :: read (const Io& io)
       antipod.resize (parameters.nrays());
        weight.resize (parameters.nrays());
 
-    Double2 direction_buffer (parameters.nrays(), Double1(3));
-
-    io.read_array (prefix+"direction", direction_buffer);
-    io.read_list  (prefix+"weight",    weight);
-
-    for (Size r = 0; r < parameters.nrays(); r++)
-    {
-        direction[r] = Vector3D (direction_buffer[r][0],
-                                 direction_buffer[r][1],
-                                 direction_buffer[r][2] );
-    }
+    io.read_array (prefix+"direction", direction);
+    io.read_list  (prefix+"weight",    weight   );
 
     const double tolerance = 1.0E-9;
 
@@ -50,15 +41,6 @@ void Rays :: write (const Io& io) const
 {
     cout << "Writing rays..." << endl;
 
-    Double2 direction_buffer (parameters.nrays(), Double1(3));
-
-    for (Size r = 0; r < parameters.nrays(); r++)
-    {
-        direction_buffer[r] = {direction[r].x(),
-                               direction[r].y(),
-                               direction[r].z() };
-    }
-
-    io.write_array (prefix+"direction", direction_buffer);
-    io.write_list  (prefix+"weight",    weight          );
+    io.write_array (prefix+"direction", direction);
+    io.write_list  (prefix+"weight",    weight   );
 }
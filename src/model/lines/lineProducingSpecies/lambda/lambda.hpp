@@ -1,6 +1,9 @@
 #pragma once
 
 
+#include <algorithm>
+#include <numeric>
+
 #include "tools/types.hpp"
 
 
@@ -16,6 +19,8 @@ struct Lambda
 
     Size1 size;
 
+    Size1 n_dropped;   ///< number of elements dropped for each (p,k)
+
     Size  nrad;   ///< number of (radiative) transitions
 
     inline void initialize (const Size nrad_new);
@@ -31,7 +36,14 @@ struct Lambda
     inline Size get_nr   (const Size p, const Size k, const Size index) const;
     inline Size get_size (const Size p, const Size k) const;
 
-    inline void add_element (const Size p, const Size k, const Size nr, const Real Ls);
+    inline void add_element  (const Size p, const Size k, const Size nr, const Real Ls);
+    inline void drop_element (const Size p, const Size k);
+
+    inline void prune (const Size max_elements);
+    inline void prune (const Size p, const Size k, const Size max_elements);
+
+    inline Size get_n_kept    () const;
+    inline Size get_n_dropped () const;
 };
 
 
@@ -5,7 +5,8 @@ inline void Lambda :: initialize (const Size nrad_new)
     Lss.reserve (parameters.npoints() * nrad);
     nrs.reserve (parameters.npoints() * nrad);
 
-    size.resize (parameters.npoints() * nrad);
+    size     .resize (parameters.npoints() * nrad);
+    n_dropped.resize (parameters.npoints() * nrad);
 
     Ls.resize (parameters.npoints());
     nr.resize (parameters.npoints());
@@ -20,7 +21,8 @@ inline void Lambda :: initialize (const Size nrad_new)
             Ls[p][k].reserve (5);
             nr[p][k].reserve (5);
 
-            size [index_first(p,k)] = 0;
+            size     [index_first(p,k)] = 0;
+            n_dropped[index_first(p,k)] = 0;
         }
     }
 }
@@ -35,6 +37,8 @@ inline void Lambda :: clear ()
         {
             Ls[p][k].clear();
             nr[p][k].clear();
+
+            n_dropped[index_first(p,k)] = 0;
         }
     })
 }
@@ -115,6 +119,112 @@ inline void Lambda :: add_element (const Size p, const Size k, const Size nr_new
 }
 
 
+///  Record an ALO element that was dropped (not added)
+///    @param[in] p : index of the receiving cell
+///    @param[in] k : index of the line transition
+///////////////////////////////////////////////////////
+inline void Lambda :: drop_element (const Size p, const Size k)
+{
+    n_dropped[index_first(p,k)]++;
+}
+
+
+///  Keep at most max_elements ALO elements for every (p,k)
+///    @param[in] max_elements : maximum number of elements per (p,k) (0: no cap)
+/////////////////////////////////////////////////////////////////////////////////
+inline void Lambda :: prune (const Size max_elements)
+{
+    if (max_elements == 0) {return;}
+
+    threaded_for (p, parameters.npoints(),
+    {
+        for (Size k = 0; k < nrad; k++)
+        {
+            prune (p, k, max_elements);
+        }
+    })
+}
+
+
+///  Keep at most max_elements ALO elements for p and k, i.e. the diagonal
+///  element and the largest (in absolute value) off-diagonal elements
+///    @param[in] p            : index of the receiving cell
+///    @param[in] k            : index of the line transition
+///    @param[in] max_elements : maximum number of elements (at least 1)
+//////////////////////////////////////////////////////////////////////////
+inline void Lambda :: prune (const Size p, const Size k, const Size max_elements)
+{
+    const Size n_elements = nr[p][k].size();
+
+    if (n_elements <= max_elements) {return;}
+
+    const Real1& Ls_pk = Ls[p][k];
+    const Size1& nr_pk = nr[p][k];
+
+    // Order the elements by magnitude, with the diagonal element first
+    Size1 order (n_elements);
+    std::iota (order.begin(), order.end(), 0);
+
+    std::partial_sort (order.begin(), order.begin()+max_elements, order.end(),
+        [&] (const Size a, const Size b)
+        {
+            if (nr_pk[a] == p) {return nr_pk[b] != p;}
+            if (nr_pk[b] == p) {return false;}
+
+            return fabs(Ls_pk[a]) > fabs(Ls_pk[b]);
+        });
+
+    // Keep the remaining elements in their original order
+    std::sort (order.begin(), order.begin()+max_elements);
+
+    Real1 Ls_kept (max_elements);
+    Size1 nr_kept (max_elements);
+
+    for (Size index = 0; index < max_elements; index++)
+    {
+        Ls_kept[index] = Ls_pk[order[index]];
+        nr_kept[index] = nr_pk[order[index]];
+    }
+
+    Ls[p][k] = Ls_kept;
+    nr[p][k] = nr_kept;
+
+    n_dropped[index_first(p,k)] += n_elements - max_elements;
+}
+
+
+///  Getter for the total number of ALO elements
+///    @return number of elements kept for all (p,k)
+///////////////////////////////////////////////////////
+inline Size Lambda :: get_n_kept () const
+{
+    Size n_kept = 0;
+
+    for (Size p = 0; p < parameters.npoints(); p++)
+    {
+        for (Size k = 0; k < nrad; k++)
+        {
+            n_kept += get_size (p,k);
+        }
+    }
+
+    return n_kept;
+}
+
+
+///  Getter for the total number of dropped ALO elements
+///    @return number of elements dropped (by tolerance or cap) for all (p,k)
+//////////////////////////////////////////////////////////////////////////////
+inline Size Lambda :: get_n_dropped () const
+{
+    Size total = 0;
+
+    for (const Size n : n_dropped) {total += n;}
+
+    return total;
+}
+
+
 
 
 inline void Lambda :: linearize_data ()
@@ -156,6 +266,9 @@ inline void Lambda :: linearize_data ()
 
 
 
+///  Gather the ALO elements of all processes (that each solved for a share
+///  of the rays), such that every process holds the sum of all contributions
+/////////////////////////////////////////////////////////////////////////////
 inline void Lambda :: MPI_gather ()
 
 #if (MPI_PARALLEL)
@@ -164,12 +277,14 @@ inline void Lambda :: MPI_gather ()
     // Linearize the Lambda operator data
     linearize_data ();
 
-    int size_total = Lss.size();
+    const int comm_size  = pc::message_passing::comm_size();
+    const int size_total = Lss.size();
+    const int size_local = parameters.npoints()*nrad;
 
 
     // Gather the lengths of the linearized vectors of each process
-    Int1 buffer_lengths (MPI_comm_size(), 0);
-    Int1 displacements  (MPI_comm_size(), 0);
+    Int1 buffer_lengths (comm_size, 0);
+    Int1 displacements  (comm_size, 0);
 
 
     int ierr_l = MPI_Allgather (
@@ -183,32 +298,27 @@ inline void Lambda :: MPI_gather ()
     assert (ierr_l == 0);
 
 
-    for (int w = 1; w < MPI_comm_size(); w++)
+    for (int w = 1; w < comm_size; w++)
     {
-        displacements[w] = buffer_lengths[w-1];
+        displacements[w] = displacements[w-1] + buffer_lengths[w-1];
     }
 
-    Real1 Lss_total;
-    Size1 nrs_total;
-    Size1 szs_total;
-
-    Size total_buffer_length = 0;
+    const Size total_buffer_length = displacements[comm_size-1] + buffer_lengths[comm_size-1];
 
-    for (Size length : buffer_lengths) {total_buffer_length += length;}
-
-    Lss_total.resize (total_buffer_length);
-    nrs_total.resize (total_buffer_length);
-    szs_total.resize (MPI_comm_size()*ncells*nrad);
+    Real1 Lss_total (total_buffer_length);
+    Size1 nrs_total (total_buffer_length);
+    Size1 szs_total (comm_size*size_local);
+    Size1 ndr_total (size_local);
 
 
     int ierr_ls = MPI_Allgatherv (
                       Lss.data(),              // pointer to data to be send
                       size_total,              // number of elements in the send buffer
-                      MPI_DOUBLE,              // type of the send data
+                      MPI_LONG_DOUBLE,         // type of the send data
                       Lss_total.data(),        // pointer to the data to be received
                       buffer_lengths.data(),   // list of numbers of elements in receive buffer
                       displacements.data(),    // displacements between data blocks
-  	                  MPI_DOUBLE,              // type of the received data
+                      MPI_LONG_DOUBLE,         // type of the received data
                       MPI_COMM_WORLD);
     assert (ierr_ls == 0);
 
@@ -216,35 +326,47 @@ inline void Lambda :: MPI_gather ()
     int ierr_nr = MPI_Allgatherv (
                       nrs.data(),              // pointer to data to be send
                       size_total,              // number of elements in the send buffer
-                      MPI_LONG,                // type of the send data
+                      MPI_UNSIGNED,            // type of the send data
                       nrs_total.data(),        // pointer to the data to be received
                       buffer_lengths.data(),   // list of numbers of elements in receive buffer
                       displacements.data(),    // displacements between data blocks
-  	                  MPI_LONG,                // type of the received data
+                      MPI_UNSIGNED,            // type of the received data
                       MPI_COMM_WORLD);
     assert (ierr_nr == 0);
 
 
     int ierr_sz = MPI_Allgather (
                       size.data(),             // pointer to data to be send
-                      ncells*nrad,             // number of elements in the send buffer
-                      MPI_LONG,                // type of the send data
+                      size_local,              // number of elements in the send buffer
+                      MPI_UNSIGNED,            // type of the send data
                       szs_total.data(),        // pointer to the data to be received
-                      ncells*nrad,             // number of elements in receive buffer
-                      MPI_LONG,                // type of the received data
+                      size_local,              // number of elements in receive buffer
+                      MPI_UNSIGNED,            // type of the received data
                       MPI_COMM_WORLD);
     assert (ierr_sz == 0);
 
 
+    int ierr_dr = MPI_Allreduce (
+                      n_dropped.data(),        // pointer to data to be reduced
+                      ndr_total.data(),        // pointer to data to be received
+                      size_local,              // number of elements to be reduced
+                      MPI_UNSIGNED,            // type of the reduced data
+                      MPI_SUM,                 // reduction operation
+                      MPI_COMM_WORLD);
+    assert (ierr_dr == 0);
+
+
     clear();
 
+    n_dropped = ndr_total;
+
 
     Size index_1 = 0;
     Size index_2 = 0;
 
-    for (Size w = 0; w < MPI_comm_size(); w++)
+    for (int w = 0; w < comm_size; w++)
     {
-        for (Size p = 0; p < ncells; p++)
+        for (Size p = 0; p < parameters.npoints(); p++)
         {
             for (Size k = 0; k < nrad; k++)
             {
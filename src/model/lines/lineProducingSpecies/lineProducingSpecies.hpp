@@ -12,6 +12,7 @@ using Eigen::COLAMDOrdering;
 #include "io/io.hpp"
 #include "model/parameters/parameters.hpp"
 #include "tools/types.hpp"
+#include "tools/timer.hpp"
 #include "linedata/linedata.hpp"
 #include "quadrature/quadrature.hpp"
 #include "lambda/lambda.hpp"
@@ -34,6 +35,11 @@ struct LineProducingSpecies
     double relative_change_max;      ///< maximum relative change
     double fraction_not_converged;   ///< fraction of levels that is not converged
 
+    double time_assembly      = 0.0;   ///< time to assemble the rate equations  (last solve)
+    double time_factorisation = 0.0;   ///< time to factorise the rate equations (last solve)
+    double time_solve         = 0.0;   ///< time to solve the factorised system  (last solve)
+    double time_convergence   = 0.0;   ///< time for the last convergence check
+
     VectorXr population;             ///< level population (most recent)
     Real1    population_tot;         ///< total level population (sum over levels)
 
@@ -52,6 +58,17 @@ struct LineProducingSpecies
     void read  (const Io& io, const Size l);
     void write (const Io& io, const Size l) const;
 
+    ///  Set the parameters of the species, its quadrature and its ALO
+    ///    @param[in] params : parameters of the model
+    //////////////////////////////////////////////////////////////////
+    inline void set_parameters (const Parameters& params)
+    {
+        parameters = params;
+
+        quadrature.parameters = params;
+        lambda    .parameters = params;
+    }
+
     void read_populations  (const Io& io, const Size l, const string tag);
     void write_populations (const Io& io, const Size l, const string tag) const;
 
@@ -69,7 +86,15 @@ struct LineProducingSpecies
 
     inline void update_using_statistical_equilibrium (
         const Double2      &abundance,
-        const Vector<Real> &temperature );
+        const Vector<Real> &temperature,
+        const Bool1        &in_grid = Bool1() );
+
+    inline void solve_statistical_equilibrium (
+        const Double2      &abundance,
+        const Vector<Real> &temperature,
+        const Bool1        &in_grid = Bool1() );
+
+    inline void MPI_gather_populations ();
 
     inline void update_using_Ng_acceleration ();
     inline void update_using_acceleration (const Size order);
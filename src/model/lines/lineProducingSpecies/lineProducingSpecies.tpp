@@ -86,6 +86,9 @@ inline void LineProducingSpecies :: update_using_LTE (
 
 inline void LineProducingSpecies :: check_for_convergence (const Real pop_prec)
 {
+    singleTimer timer;
+    timer.start();
+
     const Real weight = 1.0 / (parameters.npoints() * linedata.nlev);
 
     Real fnc = 0.0;
@@ -128,6 +131,9 @@ inline void LineProducingSpecies :: check_for_convergence (const Real pop_prec)
 
     fraction_not_converged = fnc;
     relative_change_mean   = rcm;
+
+    timer.stop();
+    time_convergence = timer.get_interval();
 }
 
 
@@ -226,15 +232,13 @@ void LineProducingSpecies :: update_using_acceleration (const Size order)
 ///  the statistical equilibrium equation taking into account the radiation field
 ///    @param[in] abundance: chemical abundances of species in the model
 ///    @param[in] temperature: gas temperature in the model
+///    @param[in] in_grid: mask of the points to solve for (empty for all points)
 /////////////////////////////////////////////////////////////////////////////////
 inline void LineProducingSpecies :: update_using_statistical_equilibrium (
     const Double2      &abundance,
-    const Vector<Real> &temperature )
+    const Vector<Real> &temperature,
+    const Bool1        &in_grid     )
 {
-    const Size non_zeros = parameters.npoints() * (      linedata.nlev
-                                                   + 6 * linedata.nrad
-                                                   + 4 * linedata.ncol_tot );
-
     population_prev3 = population_prev2;
     population_prev2 = population_prev1;
     population_prev1 = population;
@@ -242,9 +246,43 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
     residuals  .push_back(population-populations.back());
     populations.push_back(population);
 
+    solve_statistical_equilibrium (abundance, temperature, in_grid);
+}
+
+
+///  solve_statistical_equilibrium: solves the statistical equilibrium equation
+///  for the level populations, given the current radiation field (Jeff) and ALO,
+///  without keeping track of the previous iterations. With MPI, every process
+///  solves for its own range of points, and the populations are exchanged.
+///  Points outside the given mask (e.g. not in the current coarse grid) are
+///  not solved for, they keep their current populations.
+///    @param[in] abundance: chemical abundances of species in the model
+///    @param[in] temperature: gas temperature in the model
+///    @param[in] in_grid: mask of the points to solve for (empty for all points)
+/////////////////////////////////////////////////////////////////////////////////
+inline void LineProducingSpecies :: solve_statistical_equilibrium (
+    const Double2      &abundance,
+    const Vector<Real> &temperature,
+    const Bool1        &in_grid     )
+{
+    singleTimer timer;
+    timer.start();
+
+    // Every process only solves for its own (contiguous) range of points
+    const Size p_start = pc::message_passing::start (parameters.npoints());
+    const Size p_stop  = pc::message_passing::stop  (parameters.npoints());
+    const Size offset  = index (p_start, 0);
+    const Size n_local = (p_stop - p_start) * linedata.nlev;
+
+    const Size non_zeros = (p_stop - p_start) * (      linedata.nlev
+                                                 + 6 * linedata.nrad
+                                                 + 4 * linedata.ncol_tot );
+
 //    SparseMatrix<double> RT (ncells*linedata.nlev, ncells*linedata.nlev);
 
-    VectorXr y = VectorXr::Zero (parameters.npoints()*linedata.nlev);
+    RT.resize (n_local, n_local);
+
+    VectorXr y = VectorXr::Zero (n_local);
 
     vector<Triplet<Real, Size>> triplets;
 //    vector<Triplet<Real, Size>> triplets_LT;
@@ -254,8 +292,24 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
 //    triplets_LT.reserve (non_zeros);
 //    triplets_LS.reserve (non_zeros);
 
-    for (Size p = 0; p < parameters.npoints(); p++) // !!! no OMP because push_back is not thread safe !!!
+    for (Size p = p_start; p < p_stop; p++) // !!! no OMP because push_back is not thread safe !!!
     {
+        // Points that are not solved for keep their populations
+
+        if (!in_grid.empty() && !in_grid[p])
+        {
+            for (Size i = 0; i < linedata.nlev; i++)
+            {
+                const Size I = index (p, i) - offset;
+
+                triplets.push_back (Triplet<Real, Size> (I, I, 1.0));
+
+                y[I] = population (index (p, i));
+            }
+
+            continue;
+        }
+
         // Radiative transitions
 
         for (Size k = 0; k < linedata.nrad; k++)
@@ -267,8 +321,8 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
             // const Real t_JI = linedata.Ba[k] * Jdif[p][k];
 
             // Note: we define our transition matrix as the transpose of R in the paper.
-            const Size I = index (p, linedata.irad[k]);
-            const Size J = index (p, linedata.jrad[k]);
+            const Size I = index (p, linedata.irad[k]) - offset;
+            const Size J = index (p, linedata.jrad[k]) - offset;
 
             if (linedata.jrad[k] != linedata.nlev-1)
             {
@@ -289,35 +343,6 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
             }
         }
 
-        // Approximated Lambda operator
-
-        for (Size k = 0; k < linedata.nrad; k++)
-        {
-            for (Size m = 0; m < lambda.get_size(p,k); m++)
-            {
-                const Size   nr =  lambda.get_nr(p, k, m);
-                const Real v_IJ = -lambda.get_Ls(p, k, m) * get_opacity(p, k);
-
-                // Note: we define our transition matrix as the transpose of R in the paper.
-                const Size I = index (nr, linedata.irad[k]);
-                const Size J = index (p,  linedata.jrad[k]);
-
-                if (linedata.jrad[k] != linedata.nlev-1)
-                {
-                    triplets   .push_back (Triplet<Real, Size> (J, I, +v_IJ));
-                    // triplets_LT.push_back (Triplet<Real, Size> (J, I, +v_IJ));
-                }
-
-                if (linedata.irad[k] != linedata.nlev-1)
-                {
-                    triplets   .push_back (Triplet<Real, Size> (I, I, -v_IJ));
-                    // triplets_LT.push_back (Triplet<Real, Size> (I, I, -v_IJ));
-                }
-            }
-        }
-
-
-
         // Collisional transitions
 
         for (CollisionPartner &colpar : linedata.colpar)
@@ -334,8 +359,8 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
                 const Real v_JI = colpar.Ce_intpld[k] * abn;
 
                 // Note: we define our transition matrix as the transpose of R in the paper.
-                const Size I = index (p, colpar.icol[k]);
-                const Size J = index (p, colpar.jcol[k]);
+                const Size I = index (p, colpar.icol[k]) - offset;
+                const Size J = index (p, colpar.jcol[k]) - offset;
 
                 if (colpar.jcol[k] != linedata.nlev-1)
                 {
@@ -354,21 +379,67 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
 
         for (Size i = 0; i < linedata.nlev; i++)
         {
-            const Size I = index (p, linedata.nlev-1);
-            const Size J = index (p, i);
+            const Size I = index (p, linedata.nlev-1) - offset;
+            const Size J = index (p, i)               - offset;
 
             triplets.push_back (Triplet<Real, Size> (I, J, 1.0));
         }
 
-        y[index (p, linedata.nlev-1)] = population_tot[p];
+        y[index (p, linedata.nlev-1) - offset] = population_tot[p];
 
     } // for all cells
 
 
+    // Approximated Lambda operator
+    // (all elements that couple to the points of this process, where the
+    // populations of points of other processes are taken as given)
+
+    // (points that are not solved for are taken as given as well)
+
+    for (Size p = 0; p < parameters.npoints(); p++)
+    {
+        if (!in_grid.empty() && !in_grid[p]) {continue;}
+
+        const bool p_local = (p_start <= p) && (p < p_stop);
+
+        for (Size k = 0; k < linedata.nrad; k++)
+        {
+            for (Size m = 0; m < lambda.get_size(p,k); m++)
+            {
+                const Size   nr =  lambda.get_nr(p, k, m);
+                const bool   nr_local = (p_start <= nr) && (nr < p_stop)
+                                         && (in_grid.empty() || in_grid[nr]);
+
+                if (!p_local && !nr_local) {continue;}
+
+                const Real v_IJ = -lambda.get_Ls(p, k, m) * get_opacity(p, k);
+
+                // Note: we define our transition matrix as the transpose of R in the paper.
+                const Size I = index (nr, linedata.irad[k]);
+                const Size J = index (p,  linedata.jrad[k]);
+
+                if (p_local && (linedata.jrad[k] != linedata.nlev-1))
+                {
+                    if (nr_local) {triplets.push_back (Triplet<Real, Size> (J-offset, I-offset, +v_IJ));}
+                    else          {y[J-offset] -= v_IJ * population(I);}
+                }
+
+                if (nr_local && (linedata.irad[k] != linedata.nlev-1))
+                {
+                    triplets.push_back (Triplet<Real, Size> (I-offset, I-offset, -v_IJ));
+                }
+            }
+        }
+    }
+
+
     RT        .setFromTriplets (triplets   .begin(), triplets   .end());
     // LambdaStar.setFromTriplets (triplets_LS.begin(), triplets_LS.end());
     // LambdaTest.setFromTriplets (triplets_LT.begin(), triplets_LT.end());
 
+    timer.stop();
+    time_assembly = timer.get_interval();
+
 
     //cout << "Compressing RT" << endl;
 
@@ -404,6 +475,8 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
     //Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
 
 
+    timer.start();
+
     cout << "Analyzing system of rate equations..."      << endl;
 
     solver.analyzePattern (RT);
@@ -422,6 +495,9 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
         throw std::runtime_error ("Eigen solver ERROR.");
     }
 
+    timer.stop();
+    time_factorisation = timer.get_interval();
+
     //cout << "Try compute" << endl;
 
     //solver.compute (RT);
@@ -434,7 +510,12 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
 
     cout << "Solving rate equations for the level populations..." << endl;
 
-    population = solver.solve (y);
+    timer.start();
+
+    population.segment (offset, n_local) = solver.solve (y);
+
+    timer.stop();
+    time_solve = timer.get_interval();
 
     if (solver.info() != Eigen::Success)
     {
@@ -443,6 +524,9 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
         assert (false);
     }
 
+    // Exchange the populations of the points of the other processes
+    MPI_gather_populations ();
+
     cout << "Succesfully solved for the level populations!"       << endl;
 
     //OMP_PARALLEL_FOR (p, ncells)
@@ -461,3 +545,47 @@ inline void LineProducingSpecies :: update_using_statistical_equilibrium (
     //  }
     //}
 }
+
+
+
+///  Gather the level populations of all processes, each of which solved
+///  the rate equations for its own (contiguous) range of points
+/////////////////////////////////////////////////////////////////////////
+inline void LineProducingSpecies :: MPI_gather_populations ()
+
+#if (MPI_PARALLEL)
+
+{
+    const int comm_size = pc::message_passing::comm_size ();
+
+    Int1 buffer_lengths (comm_size, 0);
+    Int1 displacements  (comm_size, 0);
+
+    for (int w = 0; w < comm_size; w++)
+    {
+        const Size start = ( w   *parameters.npoints())/comm_size;
+        const Size stop  = ((w+1)*parameters.npoints())/comm_size;
+
+        buffer_lengths[w] = (stop - start) * linedata.nlev;
+        displacements [w] =  start         * linedata.nlev;
+    }
+
+    int ierr = MPI_Allgatherv (
+                   MPI_IN_PLACE,            // pointer to data to be send (here in place)
+                   0,                       // number of elements in the send buffer
+                   MPI_DATATYPE_NULL,       // type of the send data
+                   population.data(),       // pointer to the data to be received
+                   buffer_lengths.data(),   // number of elements in receive buffer
+                   displacements.data(),    // displacements between data blocks
+                   MPI_LONG_DOUBLE,         // type of the received data
+                   MPI_COMM_WORLD );
+    assert (ierr == 0);
+}
+
+#else
+
+{
+    return;
+}
+
+#endif
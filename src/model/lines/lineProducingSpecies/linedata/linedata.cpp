@@ -41,20 +41,20 @@ void Linedata :: read (const Io& io, const Size l)
     energy.resize (nlev);
     weight.resize (nlev);
 
-    io.read_list (prefix_l+"energy", energy);
-    io.read_list (prefix_l+"weight", weight);
-
     frequency.resize (nrad);
 
-    io.read_list (prefix_l+"frequency", frequency);
-
     A.resize  (nrad);
     Bs.resize (nrad);
     Ba.resize (nrad);
 
-    io.read_list (prefix_l+"A",  A);
-    io.read_list (prefix_l+"Bs", Bs);
-    io.read_list (prefix_l+"Ba", Ba);
+    // Read all (Real) lists in one go
+    io.read_lists ({prefix_l+"energy",
+                    prefix_l+"weight",
+                    prefix_l+"frequency",
+                    prefix_l+"A",
+                    prefix_l+"Bs",
+                    prefix_l+"Ba"        },
+                   {&energy, &weight, &frequency, &A, &Bs, &Ba});
 
     // Get ncolpar
     io.read_length (prefix_l+"collisionPartner_", ncolpar);
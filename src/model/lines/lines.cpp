@@ -18,6 +18,7 @@ void Lines :: read (const Io& io)
 
     /// Read line producing species data
     lineProducingSpecies.resize (parameters.nlspecs());
+    set_parameters (parameters);
 
     for (Size l = 0; l < parameters.nlspecs(); l++)
     {
@@ -69,6 +70,7 @@ void Lines :: read (const Io& io)
     emissivity   .resize (parameters.npoints(), parameters.nlines());
     opacity      .resize (parameters.npoints(), parameters.nlines());
     inverse_width.resize (parameters.npoints(), parameters.nlines());
+    min_width    .resize (parameters.npoints());
 }
 
 
@@ -116,11 +118,12 @@ void Lines :: iteration_using_Ng_acceleration (const Real pop_prec)
 void Lines :: iteration_using_statistical_equilibrium (
     const Double2      &abundance,
     const Vector<Real> &temperature,
-    const Real          pop_prec )
+    const Real          pop_prec,
+    const Bool1        &in_grid     )
 {
     for (LineProducingSpecies &lspec : lineProducingSpecies)
     {
-        lspec.update_using_statistical_equilibrium (abundance, temperature);
+        lspec.update_using_statistical_equilibrium (abundance, temperature, in_grid);
         lspec.check_for_convergence                (pop_prec);
     }
 
@@ -136,38 +139,37 @@ void Lines :: gather_emissivities_and_opacities ()
 
 {
     // Get number of processes
-    const int comm_size = MPI_comm_size ();
+    const int comm_size = pc::message_passing::comm_size ();
 
     // Extract the buffer lengths and displacements
-    int *buffer_lengths = new int[comm_size];
-    int *displacements  = new int[comm_size];
+    Int1 buffer_lengths (comm_size, 0);
+    Int1 displacements  (comm_size, 0);
 
     for (int w = 0; w < comm_size; w++)
     {
-        long start = ( w   *parameters.npoints())/comm_size;
-        long stop  = ((w+1)*parameters.npoints())/comm_size;
+        const Size start = ( w   *parameters.npoints())/comm_size;
+        const Size stop  = ((w+1)*parameters.npoints())/comm_size;
 
-        long ncells_red_w = stop - start;
-
-        buffer_lengths[w] = ncells_red_w * parameters.nlines();
+        buffer_lengths[w] = (stop - start) * parameters.nlines();
     }
 
-    displacements[0] = 0;
-
     for (int w = 1; w < comm_size; w++)
     {
-        displacements[w] = buffer_lengths[w-1];
+        displacements[w] = displacements[w-1] + buffer_lengths[w-1];
     }
 
+    emissivity.copy_ptr_to_vec ();
+    opacity   .copy_ptr_to_vec ();
+
     // Call MPI to gather the emissivity data
     int ierr_em = MPI_Allgatherv (
                       MPI_IN_PLACE,            // pointer to data to be send (here in place)
                       0,                       // number of elements in the send buffer
                       MPI_DATATYPE_NULL,       // type of the send data
-                      emissivity.data(),       // pointer to the data to be received
-                      buffer_lengths,          // number of elements in receive buffer
-                      displacements,           // displacements between data blocks
-  	                  MPI_DOUBLE,              // type of the received data
+                      emissivity.vec.data(),   // pointer to the data to be received
+                      buffer_lengths.data(),   // number of elements in receive buffer
+                      displacements.data(),    // displacements between data blocks
+                      MPI_LONG_DOUBLE,         // type of the received data
                       MPI_COMM_WORLD );
     assert (ierr_em == 0);
 
@@ -176,15 +178,15 @@ void Lines :: gather_emissivities_and_opacities ()
                       MPI_IN_PLACE,            // pointer to data to be send (here in place)
                       0,                       // number of elements in the send buffer
                       MPI_DATATYPE_NULL,       // type of the send data
-                	  opacity.data(),          // pointer to the data to be received
-                	  buffer_lengths,          // number of elements in receive buffer
-                      displacements,           // displacements between data blocks
-                	  MPI_DOUBLE,              // type of the received data
+                      opacity.vec.data(),      // pointer to the data to be received
+                      buffer_lengths.data(),   // number of elements in receive buffer
+                      displacements.data(),    // displacements between data blocks
+                      MPI_LONG_DOUBLE,         // type of the received data
                       MPI_COMM_WORLD );
     assert (ierr_op == 0);
 
-    delete [] buffer_lengths;
-    delete [] displacements;
+    emissivity.copy_vec_to_ptr ();
+    opacity   .copy_vec_to_ptr ();
 }
 
 #else
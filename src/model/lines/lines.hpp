@@ -27,10 +27,24 @@ struct Lines
     Matrix<Real> emissivity;      ///< line emissivity    (p, lid)
     Matrix<Real> opacity;         ///< line opacity       (p, lid)
     Matrix<Real> inverse_width;   ///< inverse line width (p, lid)
+    Vector<Real> min_width;       ///< smallest relative line width over all species (p)
 
     void read  (const Io& io);
     void write (const Io& io) const;
 
+    ///  Set the parameters of the lines and all line producing species
+    ///    @param[in] params : parameters of the model
+    ///////////////////////////////////////////////////////////////////
+    inline void set_parameters (const Parameters& params)
+    {
+        parameters = params;
+
+        for (LineProducingSpecies& lspec : lineProducingSpecies)
+        {
+            lspec.set_parameters (params);
+        }
+    }
+
     void iteration_using_LTE (
         const Double2      &abundance,
         const Vector<Real> &temperature);
@@ -38,7 +52,8 @@ struct Lines
     void iteration_using_statistical_equilibrium (
         const Double2      &abundance,
         const Vector<Real> &temperature,
-        const Real          pop_prec             );
+        const Real          pop_prec,
+        const Bool1        &in_grid = Bool1()    );
 
     void iteration_using_Ng_acceleration (
         const Real pop_prec              );
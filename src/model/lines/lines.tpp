@@ -1,3 +1,5 @@
+#include <limits>
+
 #include "paracabs.hpp"
 #include "tools/types.hpp"
 
@@ -53,23 +55,32 @@ inline void Lines :: set_emissivity_and_opacity ()
 }
 
 
-///  Setter for line widths
+///  Setter for line widths (inverse line widths and smallest relative width)
 ///    @param[in] thermodynamics : reference to thermodynamics module
-/////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
 inline void Lines :: set_inverse_width (const Thermodynamics& thermodynamics)
 {
     threaded_for (p, parameters.npoints(),
     {
+        min_width[p] = std::numeric_limits<Real>::max();
+
         for (Size l = 0; l < parameters.nlspecs(); l++)
         {
+            const Real invr_mass = lineProducingSpecies[l].linedata.inverse_mass;
+            const Real rel_width = thermodynamics.profile_width (invr_mass, p);
+
+            if (min_width[p] > rel_width)
+            {
+                min_width[p] = rel_width;
+            }
+
             for (Size k = 0; k < lineProducingSpecies[l].linedata.nrad; k++)
             {
-                const Real invr_mass = lineProducingSpecies[l].linedata.inverse_mass;
                 const Real frequency = lineProducingSpecies[l].linedata.frequency[k];
 
                 const Size lid = line_index (l, k);
 
-                inverse_width (p, lid) = (Real) 1.0 / thermodynamics.profile_width (invr_mass, p, frequency);
+                inverse_width (p, lid) = (Real) 1.0 / (frequency * rel_width);
             }
         }
     })
@@ -1,11 +1,30 @@
+#include <limits>
+#include <Eigen/Dense>
+
 #include "paracabs.hpp"
 #include "model.hpp"
 #include "tools/heapsort.hpp"
+#include "tools/numa.hpp"
 #include "solver/solver.hpp"
 
 
+///  Share the parameters of the model with all its parts
+///////////////////////////////////////////////////////////
+void Model :: set_parameters ()
+{
+    geometry      .set_parameters (parameters);
+    chemistry     .set_parameters (parameters);
+    thermodynamics.set_parameters (parameters);
+    lines         .set_parameters (parameters);
+    radiation     .set_parameters (parameters);
+}
+
+
 void Model :: read (const Io& io)
 {
+    // Parts (e.g. line producing species) might have been replaced
+    set_parameters ();
+
     cout << "                                           " << endl;
     cout << "-------------------------------------------" << endl;
     cout << "  Reading Model...                         " << endl;
@@ -36,6 +55,9 @@ void Model :: read (const Io& io)
     cout << "  nquads     = " << parameters.nquads     () << endl;
     cout << "-------------------------------------------" << endl;
     cout << "                                           " << endl;
+
+    // Nothing derived from the new data has been computed yet
+    dependencies.mark_all_stale ();
 }
 
 
@@ -50,195 +72,382 @@ void Model :: write (const Io& io) const
 }
 
 
-int Model :: compute_inverse_line_widths ()
+///  Getter for the graph of dependencies between the quantities in a model
+///    @return dependency graph (with all derived quantities stale)
+///////////////////////////////////////////////////////////////////////////
+DependencyGraph Model :: get_dependency_graph ()
 {
-    cout << "Computing inverse line widths..." << endl;
+    DependencyGraph graph (n_quantities);
 
-    lines.set_inverse_width (thermodynamics);
+    // Line widths depend on the thermal and turbulent velocities
+    graph.add_dependency (Q_InverseWidths,     Q_Temperature  );
+    graph.add_dependency (Q_InverseWidths,     Q_Turbulence   );
+    graph.add_dependency (Q_InverseWidths,     Q_LineData     );
 
-    return (0);
+    // Spectral discretisation is centred on the lines, scaled by their widths
+    graph.add_dependency (Q_Frequencies,       Q_InverseWidths);
+    graph.add_dependency (Q_Frequencies,       Q_LineData     );
+
+    // Ray lengths depend on the Doppler shifts and the line widths
+    graph.add_dependency (Q_RayLengths,        Q_Geometry     );
+    graph.add_dependency (Q_RayLengths,        Q_InverseWidths);
+    graph.add_dependency (Q_RayLengths,        Q_Temperature  );
+    graph.add_dependency (Q_RayLengths,        Q_Turbulence   );
+    graph.add_dependency (Q_RayLengths,        Q_LineData     );
+
+    // Boundary condition is evaluated at each frequency
+    graph.add_dependency (Q_BoundaryCondition, Q_Boundary     );
+    graph.add_dependency (Q_BoundaryCondition, Q_Frequencies  );
+
+    // Separate position and velocity components used by the ray tracer
+    graph.add_dependency (Q_PointComponents,   Q_Geometry     );
+
+    return graph;
 }
 
 
+///  Setter for the gas temperature
+///    @param[in] temperature : new gas temperature at each point
+/////////////////////////////////////////////////////////////////
+void Model :: set_temperature (const Real1& temperature)
+{
+    thermodynamics.temperature.gas.vec = temperature;
+    thermodynamics.temperature.gas.set_dat ();
+    thermodynamics.temperature.gas.copy_vec_to_ptr ();
 
-///  Compute spectral (=frequency) discretisation
-/////////////////////////////////////////////////
-int Model :: compute_spectral_discretisation ()
+    mark_changed (Q_Temperature);
+}
+
+
+///  Setter for the (squared) turbulent velocity
+///    @param[in] vturb2 : new microturbulence over c, squared, at each point
+////////////////////////////////////////////////////////////////////////////
+void Model :: set_turbulence (const Real1& vturb2)
 {
-    cout << "Computing spectral discretisation..." << endl;
+    thermodynamics.turbulence.vturb2.vec = vturb2;
+    thermodynamics.turbulence.vturb2.set_dat ();
+    thermodynamics.turbulence.vturb2.copy_vec_to_ptr ();
 
-    threaded_for (p, parameters.npoints(),
+    mark_changed (Q_Turbulence);
+}
+
+
+///  Setter for the velocity field
+///    @param[in] velocity : new velocity (over c) at each point (npoints x 3)
+/////////////////////////////////////////////////////////////////////////////
+void Model :: set_velocity (const Double2& velocity)
+{
+    for (Size p = 0; p < parameters.npoints(); p++)
     {
-        Real1 freqs (parameters.nfreqs());
-        Size1 nmbrs (parameters.nfreqs());
+        geometry.points.velocity.vec[p] = Vector3D (velocity[p][0], velocity[p][1], velocity[p][2]);
+    }
 
-        Size index0 = 0;
-        Size index1 = 0;
+    geometry.points.velocity.copy_vec_to_ptr ();
 
-        // Add the line frequencies (over the profile)
-        for (Size l = 0; l < parameters.nlspecs(); l++)
-        {
-            const Real inverse_mass = lines.lineProducingSpecies[l].linedata.inverse_mass;
+    mark_changed (Q_Geometry);
+}
 
-            for (Size k = 0; k < lines.lineProducingSpecies[l].linedata.nrad; k++)
-            {
-                const Real freqs_line = lines.line[index0];
-                const Real width      = freqs_line * thermodynamics.profile_width (inverse_mass, p);
 
-                for (Size z = 0; z < parameters.nquads(); z++)
-                {
-                    const Real root = lines.lineProducingSpecies[l].quadrature.roots[z];
+///  Setter for the temperature of the boundary
+///    @param[in] temperature : new temperature at each boundary point
+//////////////////////////////////////////////////////////////////////
+void Model :: set_boundary_temperature (const Real1& temperature)
+{
+    geometry.boundary.boundary_temperature.vec = temperature;
+    geometry.boundary.boundary_temperature.set_dat ();
+    geometry.boundary.boundary_temperature.copy_vec_to_ptr ();
+
+    mark_changed (Q_Boundary);
+}
 
-                    freqs[index1] = freqs_line + width * root;
-                    nmbrs[index1] = index1;
 
-                    index1++;
-                }
+///  Mark a quantity as changed, such that all quantities derived from it
+///  are recomputed (by update) before they are used again. Use this after
+///  changing data directly, e.g. line data or the positions of the points.
+///    @param[in] quantity : changed quantity
+///////////////////////////////////////////////////////////////////////////
+void Model :: mark_changed (const Quantity quantity)
+{
+    dependencies.mark_changed (quantity);
+
+    // The change is accounted for, it need not be detected again
+    fingerprints[quantity] = get_fingerprint (quantity);
+}
+
+
+///  Check whether a (derived) quantity needs to be recomputed
+///    @param[in] quantity : quantity to check
+///    @return true if the quantity is stale
+//////////////////////////////////////////////////////////////
+bool Model :: is_stale (const Quantity quantity)
+{
+    detect_changes ();
+
+    return dependencies.is_stale (quantity);
+}
 
-                index0++;
+
+///  Getter for the fingerprint of the values of an input quantity
+///    @param[in] quantity : input quantity
+///    @return fingerprint of its values (0 if it is not fingerprinted)
+//////////////////////////////////////////////////////////////////////
+size_t Model :: get_fingerprint (const Quantity quantity) const
+{
+    Fingerprint fingerprint;
+
+    switch (quantity)
+    {
+        case Q_Temperature:
+            for (const Real T : thermodynamics.temperature.gas.vec) {fingerprint.add (T);}
+            break;
+
+        case Q_Turbulence:
+            for (const Real v : thermodynamics.turbulence.vturb2.vec) {fingerprint.add (v);}
+            break;
+
+        case Q_Boundary:
+            for (const Real T : geometry.boundary.boundary_temperature.vec) {fingerprint.add (T);}
+            break;
+
+        case Q_Geometry:
+            for (const Vector3D& x : geometry.points.position.vec)
+            {
+                fingerprint.add (x.x());
+                fingerprint.add (x.y());
+                fingerprint.add (x.z());
             }
-        }
+            for (const Vector3D& v : geometry.points.velocity.vec)
+            {
+                fingerprint.add (v.x());
+                fingerprint.add (v.y());
+                fingerprint.add (v.z());
+            }
+            break;
+
+        default:
+            return 0;
+    }
+
+    return fingerprint.hash;
+}
 
-        // Sort frequencies
-        heapsort (freqs, nmbrs);
 
+///  Detect changes of the inputs that were made directly in the data (e.g.
+///  from python), rather than through the setters, and mark them changed.
+///  (Changes in the line data still have to be marked with mark_changed.)
+///////////////////////////////////////////////////////////////////////////
+void Model :: detect_changes ()
+{
+    for (const Quantity quantity : {Q_Geometry, Q_Temperature, Q_Turbulence, Q_Boundary})
+    {
+        const size_t fingerprint = get_fingerprint (quantity);
 
-        // Set all frequencies nu
-        for (Size fl = 0; fl < parameters.nfreqs(); fl++)
+        if (fingerprint != fingerprints[quantity])
         {
-            radiation.frequencies.nu(p, fl) = freqs[fl];
+            fingerprints[quantity] = fingerprint;
+
+            dependencies.mark_changed (quantity);
         }
+    }
+}
 
 
-        // Create lookup table for the frequency corresponding to each line
-        Size1 nmbrs_inverted (parameters.nfreqs());
+///  Recompute the stale derived quantities (the spectral discretisation and
+///  boundary condition only if they were set up before, and the ray lengths
+///  are recomputed by the solver when required)
+///    @return number of recomputed quantities
+//////////////////////////////////////////////////////////////////////////
+int Model :: update ()
+{
+    int n_updated = 0;
 
-        for (Size fl = 0; fl < parameters.nfreqs(); fl++)
-        {
-            nmbrs_inverted[nmbrs[fl]] = fl;
+    if (is_stale (Q_PointComponents))
+    {
+        geometry.points.set_components ();
+        dependencies.mark_computed (Q_PointComponents);
+        n_updated++;
+    }
 
-            radiation.frequencies.appears_in_line_integral[fl] = false;;
-            radiation.frequencies.corresponding_l_for_spec[fl] = parameters.nfreqs();
-            radiation.frequencies.corresponding_k_for_tran[fl] = parameters.nfreqs();
-            radiation.frequencies.corresponding_z_for_line[fl] = parameters.nfreqs();
-        }
+    if (is_stale (Q_InverseWidths))
+    {
+        compute_inverse_line_widths ();
+        n_updated++;
+    }
 
-        Size index2 = 0;
+    // Only the line discretisation can be recomputed without further input
+    if (is_stale (Q_Frequencies) && (spectralDiscretisation == SD_Lines))
+    {
+        compute_spectral_discretisation ();
+        n_updated++;
+    }
 
-        for (Size l = 0; l < parameters.nlspecs(); l++)
-        {
-            for (Size k = 0; k < lines.lineProducingSpecies[l].nr_line[p].size(); k++)
-            {
-                for (Size z = 0; z < lines.lineProducingSpecies[l].nr_line[p][k].size(); z++)
-                {
-                    lines.lineProducingSpecies[l].nr_line[p][k][z] = nmbrs_inverted[index2];
+    if (is_stale (Q_BoundaryCondition) && (boundary_condition.vec.size() > 0))
+    {
+        set_boundary_condition ();
+        n_updated++;
+    }
 
-                    radiation.frequencies.appears_in_line_integral[index2] = true;
-                    radiation.frequencies.corresponding_l_for_spec[index2] = l;
-                    radiation.frequencies.corresponding_k_for_tran[index2] = k;
-                    radiation.frequencies.corresponding_z_for_line[index2] = z;
+    return n_updated;
+}
 
-                    index2++;
-                }
-            }
-        }
-    })
 
-    // Set spectral discretisation setting
-    spectralDiscretisation = SD_Lines;
+///  Place the large arrays (radiation field, line emissivities, opacities
+///  and level populations) on the NUMA nodes of the threads that use them,
+///  by first touching them with the same partitioning over the points as
+///  the solver. Call after reading the model (and before solving).
+///    @param[in] pin_threads : first pin every thread to its own cpu
+///////////////////////////////////////////////////////////////////////////
+int Model :: place_memory_numa (const bool pin_threads)
+{
+    cout << "Placing memory on NUMA nodes..." << endl;
+
+    if (pin_threads) {numa_pin_threads ();}
+
+    const Size npoints = parameters.npoints();
+    const Size nfreqs  = parameters.nfreqs ();
+    const Size nlines  = parameters.nlines ();
+
+    numa_first_touch (radiation.I.vec.data(), radiation.I.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+    numa_first_touch (radiation.u.vec.data(), radiation.u.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+    numa_first_touch (radiation.v.vec.data(), radiation.v.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+    numa_first_touch (radiation.J.vec.data(), radiation.J.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+
+    numa_first_touch (lines.emissivity.vec.data(), lines.emissivity.vec.size() / (npoints*nlines), npoints, nlines);
+    numa_first_touch (lines.opacity   .vec.data(), lines.opacity   .vec.size() / (npoints*nlines), npoints, nlines);
+
+    // (The number of slabs is 0 for arrays that are not allocated)
+    for (LineProducingSpecies& lspec : lines.lineProducingSpecies)
+    {
+        const Size nlev = lspec.linedata.nlev;
+
+        numa_first_touch (lspec.population.data(), lspec.population.size() / (npoints*nlev), npoints, nlev);
+    }
+
+    radiation.I.copy_vec_to_ptr ();
+    radiation.u.copy_vec_to_ptr ();
+    radiation.v.copy_vec_to_ptr ();
+    radiation.J.copy_vec_to_ptr ();
+
+    lines.emissivity.copy_vec_to_ptr ();
+    lines.opacity   .copy_vec_to_ptr ();
+
+    report_memory_placement ();
 
     return (0);
 }
 
 
-///  Computer for spectral (=frequency) discretisation
-///  Gives same frequency bins to each point
-///    @param[in] width : corresponding line width for frequency bins
-/////////////////////////////////////////////////////////////////////
-int Model :: compute_spectral_discretisation (const Real width)
+///  Print which fraction of the pages of the large arrays are on the NUMA
+///  node of the threads that handle them in the solver
+//////////////////////////////////////////////////////////////////////////
+void Model :: report_memory_placement () const
 {
-    cout << "Computing spectral discretisation..." << endl;
+    const Size npoints = parameters.npoints();
+    const Size nfreqs  = parameters.nfreqs ();
+    const Size nlines  = parameters.nlines ();
 
-    threaded_for (p, parameters.npoints(),
+    cout << "Memory placement (pages local to the threads using them):" << endl;
+
+    numa_report ("  I         ", radiation.I.vec.data(), radiation.I.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+    numa_report ("  u         ", radiation.u.vec.data(), radiation.u.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+    numa_report ("  v         ", radiation.v.vec.data(), radiation.v.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+    numa_report ("  J         ", radiation.J.vec.data(), radiation.J.vec.size() / (npoints*nfreqs), npoints, nfreqs);
+
+    numa_report ("  emissivity", lines.emissivity.vec.data(), lines.emissivity.vec.size() / (npoints*nlines), npoints, nlines);
+    numa_report ("  opacity   ", lines.opacity   .vec.data(), lines.opacity   .vec.size() / (npoints*nlines), npoints, nlines);
+
+    for (const LineProducingSpecies& lspec : lines.lineProducingSpecies)
     {
-        Real1 freqs (parameters.nfreqs());
-        Size1 nmbrs (parameters.nfreqs());
+        const Size nlev = lspec.linedata.nlev;
 
-        Size index0 = 0;
-        Size index1 = 0;
+        numa_report ("  population", lspec.population.data(), lspec.population.size() / (npoints*nlev), npoints, nlev);
+    }
+}
 
 
-        // Add the line frequencies (over the profile)
-        for (Size l = 0; l < parameters.nlspecs(); l++)
-        {
-            for (Size k = 0; k < lines.lineProducingSpecies[l].linedata.nrad; k++)
-            {
-                const Real freqs_line = lines.line[index0];
+int Model :: compute_inverse_line_widths ()
+{
+    cout << "Computing inverse line widths..." << endl;
 
-                for (Size z = 0; z < parameters.nquads(); z++)
-                {
-                    const Real root = lines.lineProducingSpecies[l].quadrature.roots[z];
+    lines.set_inverse_width (thermodynamics);
 
-                    freqs[index1] = freqs_line + freqs_line * width * root;
-                    nmbrs[index1] = index1;
+    dependencies.mark_computed (Q_InverseWidths);
 
-                    index1++;
-                }
+    return (0);
+}
 
-                index0++;
-            }
-        }
 
 
-        // Sort frequencies
-        heapsort (freqs, nmbrs);
+///  Compute spectral (=frequency) discretisation
+///  The widths scale with the local line profile width of each species
+/////////////////////////////////////////////////////////////////////////
+int Model :: compute_spectral_discretisation ()
+{
+    cout << "Computing spectral discretisation..." << endl;
 
+    radiation.frequencies.resize (parameters.nlspecs());
 
-        // Set all frequencies nu
-        for (Size fl = 0; fl < parameters.nfreqs(); fl++)
+    threaded_for (p, parameters.npoints(),
+    {
+        for (Size l = 0; l < parameters.nlspecs(); l++)
         {
-            radiation.frequencies.nu(p, fl) = freqs[fl];
+            const Real inverse_mass = lines.lineProducingSpecies[l].linedata.inverse_mass;
+
+            radiation.frequencies.width_factor(p, l) = thermodynamics.profile_width (inverse_mass, p);
         }
+    })
 
+    compute_line_frequency_grid (radiation.frequencies.merge_tolerance);
 
+    // Set spectral discretisation setting
+    spectralDiscretisation = SD_Lines;
 
-        // Create lookup table for the frequency corresponding to each line
-        Size1 nmbrs_inverted (parameters.nfreqs());
+    // The discretisation might differ from the previous one (e.g. another type)
+    dependencies.mark_computed (Q_Frequencies);
+    dependencies.mark_changed  (Q_Frequencies);
 
-        for (Size fl = 0; fl < parameters.nfreqs(); fl++)
-        {
-            nmbrs_inverted[nmbrs[fl]] = fl;
+    return (0);
+}
 
-            radiation.frequencies.appears_in_line_integral[fl] = false;;
-            radiation.frequencies.corresponding_l_for_spec[fl] = parameters.nfreqs();
-            radiation.frequencies.corresponding_k_for_tran[fl] = parameters.nfreqs();
-            radiation.frequencies.corresponding_z_for_line[fl] = parameters.nfreqs();
-        }
 
-        Size index2 = 0;
+///  Compute spectral (=frequency) discretisation, merging line frequencies
+///  (of different lines) that are closer than the given relative tolerance
+///    @param[in] tolerance : relative distance below which bins are merged
+//////////////////////////////////////////////////////////////////////////////
+int Model :: compute_spectral_discretisation_merged (const Real tolerance)
+{
+    radiation.frequencies.merge_tolerance = tolerance;
 
-        for (Size l = 0; l < parameters.nlspecs(); l++)
-        {
-            for (Size k = 0; k < lines.lineProducingSpecies[l].nr_line[p].size(); k++)
-            {
-                for (Size z = 0; z < lines.lineProducingSpecies[l].nr_line[p][k].size(); z++)
-                {
-                    lines.lineProducingSpecies[l].nr_line[p][k][z] = nmbrs_inverted[index2];
+    return compute_spectral_discretisation ();
+}
 
-                    radiation.frequencies.appears_in_line_integral[index2] = true;
-                    radiation.frequencies.corresponding_l_for_spec[index2] = l;
-                    radiation.frequencies.corresponding_k_for_tran[index2] = k;
-                    radiation.frequencies.corresponding_z_for_line[index2] = z;
 
-                    index2++;
-                }
-            }
+///  Computer for spectral (=frequency) discretisation
+///  Gives same frequency bins to each point
+///    @param[in] width : corresponding line width for frequency bins
+/////////////////////////////////////////////////////////////////////
+int Model :: compute_spectral_discretisation (const Real width)
+{
+    cout << "Computing spectral discretisation..." << endl;
+
+    radiation.frequencies.resize (parameters.nlspecs());
+
+    threaded_for (p, parameters.npoints(),
+    {
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            radiation.frequencies.width_factor(p, l) = width;
         }
     })
 
+    compute_line_frequency_grid (0.0);
+
     // Set spectral discretisation setting
     spectralDiscretisation = SD_Image;
 
+    dependencies.mark_computed (Q_Frequencies);
+    dependencies.mark_changed  (Q_Frequencies);
+
     return (0);
 }
 
@@ -256,104 +465,317 @@ int Model :: compute_spectral_discretisation (
 
     const long double dnu = (nu_max - nu_min) / (parameters.nfreqs() - 1);
 
-    threaded_for (p, parameters.npoints(),
+    radiation.frequencies.resize (1);
+
+    for (Size f = 0; f < parameters.nfreqs(); f++)
     {
-        for (Size f = 0; f < parameters.nfreqs(); f++)
-        {
-            radiation.frequencies.nu(p, f) = (Real) (nu_min + f*dnu);
+        radiation.frequencies.nu_centre  [f] = (Real) (nu_min + f*dnu);
+        radiation.frequencies.nu_offset  [f] = 0.0;
+        radiation.frequencies.width_index[f] = 0;
+
+        radiation.frequencies.appears_in_line_integral[f] = false;;
+        radiation.frequencies.first_component         [f] = 0;
+        radiation.frequencies.corresponding_l_for_spec[f] = parameters.nfreqs();
+        radiation.frequencies.corresponding_k_for_tran[f] = parameters.nfreqs();
+        radiation.frequencies.corresponding_z_for_line[f] = parameters.nfreqs();
+    }
 
-            radiation.frequencies.appears_in_line_integral[f] = false;;
-            radiation.frequencies.corresponding_l_for_spec[f] = parameters.nfreqs();
-            radiation.frequencies.corresponding_k_for_tran[f] = parameters.nfreqs();
-            radiation.frequencies.corresponding_z_for_line[f] = parameters.nfreqs();
-        }
-    })
+    radiation.frequencies.first_component[parameters.nfreqs()] = 0;
+    radiation.frequencies.nfreqs_red                           = parameters.nfreqs();
+
+    radiation.frequencies.nu_centre   .copy_vec_to_ptr ();
+    radiation.frequencies.nu_offset   .copy_vec_to_ptr ();
+    radiation.frequencies.width_index .copy_vec_to_ptr ();
+    radiation.frequencies.width_factor.copy_vec_to_ptr ();
 
     // Set spectral discretisation setting
     spectralDiscretisation = SD_Image;
 
+    dependencies.mark_computed (Q_Frequencies);
+    dependencies.mark_changed  (Q_Frequencies);
+
     return (0);
 }
 
 
-/// Computer for the level populations, assuming LTE
-////////////////////////////////////////////////////
-int Model :: compute_LTE_level_populations ()
+///  Check whether a line frequency can be merged into a frequency bin, i.e.
+///  if it is within the merge tolerance of the bin frequency at every point
+///    @param[in] freqs  : frequencies (with width factors set)
+///    @param[in] f      : index of the frequency bin
+///    @param[in] centre : [Hz] line centre of the line frequency
+///    @param[in] offset : [Hz] offset from the centre per unit width
+///    @param[in] w      : index of the width factor of the line frequency
+///    @param[in] tolerance : relative distance below which bins are merged
+///    @return true if the line frequency can be merged into bin f
+//////////////////////////////////////////////////////////////////////////////
+inline bool can_merge_frequencies (
+    const Frequencies& freqs,
+    const Size         f,
+    const Real         centre,
+    const Real         offset,
+    const Size         w,
+    const Real         tolerance )
 {
-    cout << "Computing LTE level populations..." << endl;
+    if (tolerance <= 0.0) {return false;}
 
-    // Initialize levels, emissivities and opacities with LTE values
-    lines.iteration_using_LTE (chemistry.species.abundance, thermodynamics.temperature.gas);
+    for (Size p = 0; p < freqs.parameters.npoints(); p++)
+    {
+        const Real nu_bin = freqs.nu (p, f);
+        const Real nu_new = centre + offset * freqs.width_factor(p, w);
 
-    return (0);
+        if (fabs (nu_new - nu_bin) > tolerance * nu_bin) {return false;}
+    }
+
+    return true;
 }
 
 
-///  Computer for the radiation field
-/////////////////////////////////////
-int Model :: compute_radiation_field_shortchar_order_0 ()
+///  Computer for the (shared) frequency grid over the line profiles
+///  The bins are sorted for the mean width of each species, and the same
+///  ordering is used at every point, such that each bin always corresponds
+///  to the same (l,k,z). (Where lines of different species overlap, the
+///  local widths can make the bins not strictly ascending at some points.)
+///  Consecutive line frequencies that are within the merge tolerance of
+///  each other (at every point) share one bin, see can_merge_frequencies.
+///  Assumes the width factors (p,l) have been set.
+///    @param[in] tolerance : relative distance below which bins are merged
+/////////////////////////////////////////////////////////////////////////////
+void Model :: compute_line_frequency_grid (const Real tolerance)
 {
-    cout << "Computing radiation field..." << endl;
+    Frequencies& freqs = radiation.frequencies;
 
-    // const Size length_max = 4*parameters.npoints() + 1;
-    // const Size  width_max =   parameters.nfreqs ();
+    // Get the mean width of each species as reference
+    Real1 width_ref (parameters.nlspecs(), 0.0);
 
-    // Solver solver (length_max, width_max, parameters.n_off_diag);
+    for (Size p = 0; p < parameters.npoints(); p++)
+    {
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            width_ref[l] += freqs.width_factor(p, l);
+        }
+    }
 
-    Solver solver;
-    solver.setup <CoMoving>        (*this);
-    solver.solve_shortchar_order_0 (*this);
+    for (Size l = 0; l < parameters.nlspecs(); l++)
+    {
+        width_ref[l] /= parameters.npoints();
+    }
 
-    return (0);
-}
+    // Add the line frequencies (over the profile)
+    Real1 centre (parameters.nfreqs());
+    Real1 offset (parameters.nfreqs());
+    Real1 nu_ref (parameters.nfreqs());
+    Size1 nmbrs  (parameters.nfreqs());
+    Size1 l_nmbr (parameters.nfreqs());
+    Size1 k_nmbr (parameters.nfreqs());
+    Size1 z_nmbr (parameters.nfreqs());
 
+    Size index0 = 0;
+    Size index1 = 0;
 
-///  Computer for the radiation field
-/////////////////////////////////////
-int Model :: compute_radiation_field_feautrier_order_2 ()
-{
-    cout << "Computing radiation field..." << endl;
+    for (Size l = 0; l < parameters.nlspecs(); l++)
+    {
+        for (Size k = 0; k < lines.lineProducingSpecies[l].linedata.nrad; k++)
+        {
+            const Real freqs_line = lines.line[index0];
 
-    // const Size length_max = 4*parameters.npoints() + 1;
-    // const Size  width_max =   parameters.nfreqs ();
+            for (Size z = 0; z < parameters.nquads(); z++)
+            {
+                const Real root = lines.lineProducingSpecies[l].quadrature.roots[z];
 
-    // Solver solver (length_max, width_max, parameters.n_off_diag);
+                centre[index1] = freqs_line;
+                offset[index1] = freqs_line * root;
+                nu_ref[index1] = freqs_line + freqs_line * width_ref[l] * root;
+                nmbrs [index1] = index1;
+                l_nmbr[index1] = l;
+                k_nmbr[index1] = k;
+                z_nmbr[index1] = z;
 
-    Solver solver;
-    solver.setup <CoMoving>        (*this);
-    solver.solve_feautrier_order_2 (*this);
+                index1++;
+            }
 
-    return (0);
-}
+            index0++;
+        }
+    }
 
+    // Sort frequencies (once, for all points)
+    heapsort (nu_ref, nmbrs);
 
-///  Compute the effective mean intensity in a line
-///////////////////////////////////////////////////
-int Model :: compute_Jeff ()
-{
-    for (LineProducingSpecies &lspec : lines.lineProducingSpecies)
+    // Set the (sorted) grid and the lookup table for the line of each frequency
+    // (merging components into the previous bin if they are close enough)
+    Size1 nmbrs_inverted (parameters.nfreqs());
+
+    Size f = 0;
+
+    for (Size c = 0; c < parameters.nfreqs(); c++)
     {
-       // Lambda = MatrixXd::Zero (lspec.population.size(), lspec.population.size());
+        const Size i = nmbrs[c];
 
-        threaded_for (p, parameters.npoints(),
+        if ((c == 0) || !can_merge_frequencies (freqs, f-1, centre[i], offset[i], l_nmbr[i], tolerance))
         {
-            for (Size k = 0; k < lspec.linedata.nrad; k++)
-            {
-                const Size1 freq_nrs = lspec.nr_line[p][k];
+            freqs.nu_centre  [f] = centre[i];
+            freqs.nu_offset  [f] = offset[i];
+            freqs.width_index[f] = l_nmbr[i];
 
-                // Initialize values
-                lspec.Jlin[p][k] = 0.0;
+            freqs.appears_in_line_integral[f] = true;
+            freqs.first_component         [f] = c;
 
-                // Integrate over the line
-                for (Size z = 0; z < parameters.nquads(); z++)
-                {
-                    lspec.Jlin[p][k] += lspec.quadrature.weights[z] * radiation.J(p, freq_nrs[z]);
-                }
+            f++;
+        }
 
+        nmbrs_inverted[i] = f-1;
 
-                double diff = 0.0;
+        freqs.corresponding_l_for_spec[c] = l_nmbr[i];
+        freqs.corresponding_k_for_tran[c] = k_nmbr[i];
+        freqs.corresponding_z_for_line[c] = z_nmbr[i];
+    }
 
-                // Collect the approximated part
+    freqs.nfreqs_red = f;
+
+    // Unused bins do not correspond to any component
+    for (; f < parameters.nfreqs(); f++)
+    {
+        freqs.nu_centre  [f] = 0.0;
+        freqs.nu_offset  [f] = 0.0;
+        freqs.width_index[f] = 0;
+
+        freqs.appears_in_line_integral[f] = false;
+        freqs.first_component         [f] = parameters.nfreqs();
+    }
+
+    freqs.first_component[parameters.nfreqs()] = parameters.nfreqs();
+
+    if (freqs.nfreqs_red < parameters.nfreqs())
+    {
+        cout << "Merged frequency bins, nfreqs_red = " << freqs.nfreqs_red << endl;
+    }
+
+    freqs.nu_centre   .copy_vec_to_ptr ();
+    freqs.nu_offset   .copy_vec_to_ptr ();
+    freqs.width_index .copy_vec_to_ptr ();
+    freqs.width_factor.copy_vec_to_ptr ();
+
+    threaded_for (p, parameters.npoints(),
+    {
+        Size index2 = 0;
+
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            for (Size k = 0; k < lines.lineProducingSpecies[l].nr_line[p].size(); k++)
+            {
+                for (Size z = 0; z < lines.lineProducingSpecies[l].nr_line[p][k].size(); z++)
+                {
+                    lines.lineProducingSpecies[l].nr_line[p][k][z] = nmbrs_inverted[index2];
+
+                    index2++;
+                }
+            }
+        }
+    })
+}
+
+
+/// Computer for the level populations, assuming LTE
+////////////////////////////////////////////////////
+int Model :: compute_LTE_level_populations ()
+{
+    cout << "Computing LTE level populations..." << endl;
+
+    // Initialize levels, emissivities and opacities with LTE values
+    lines.iteration_using_LTE (chemistry.species.abundance, thermodynamics.temperature.gas);
+
+    return (0);
+}
+
+
+///  Computer for the radiation field
+/////////////////////////////////////
+int Model :: compute_radiation_field_shortchar_order_0 ()
+{
+    cout << "Computing radiation field..." << endl;
+
+    // Recompute whatever became stale since the last solve
+    update ();
+
+    // const Size length_max = 4*parameters.npoints() + 1;
+    // const Size  width_max =   parameters.nfreqs ();
+
+    // Solver solver (length_max, width_max, parameters.n_off_diag);
+
+    Solver solver;
+    solver.setup <CoMoving>        (*this);
+    solver.solve_shortchar_order_0 (*this);
+
+    return (0);
+}
+
+
+///  Computer for the radiation field
+/////////////////////////////////////
+int Model :: compute_radiation_field_feautrier_order_2 ()
+{
+    cout << "Computing radiation field..." << endl;
+
+    // Recompute whatever became stale since the last solve
+    update ();
+
+    // const Size length_max = 4*parameters.npoints() + 1;
+    // const Size  width_max =   parameters.nfreqs ();
+
+    // Solver solver (length_max, width_max, parameters.n_off_diag);
+
+    Solver solver;
+    solver.setup <CoMoving>        (*this);
+    solver.solve_feautrier_order_2 (*this);
+
+    n_formal_solutions++;
+
+    return (0);
+}
+
+
+///  Compute the scattered intensity from the last formal solution, such
+///  that it is included in the source of the next one (with use_scattering)
+////////////////////////////////////////////////////////////////////////////
+int Model :: compute_scattered_intensity ()
+{
+    cout << "Computing scattered intensity..." << endl;
+
+    radiation.calc_U (geometry.rays);
+
+    return (0);
+}
+
+
+///  Compute the effective mean intensity in a line
+///////////////////////////////////////////////////
+int Model :: compute_Jeff ()
+{
+    for (LineProducingSpecies &lspec : lines.lineProducingSpecies)
+    {
+       // Lambda = MatrixXd::Zero (lspec.population.size(), lspec.population.size());
+
+        threaded_for (p, parameters.npoints(),
+        {
+            // Points that are not in the current (coarse) grid are skipped
+            if (!geometry.points.multiscale.in_grid (p)) {continue;}
+
+            for (Size k = 0; k < lspec.linedata.nrad; k++)
+            {
+                const Size1 freq_nrs = lspec.nr_line[p][k];
+
+                // Initialize values
+                lspec.Jlin[p][k] = 0.0;
+
+                // Integrate over the line
+                for (Size z = 0; z < parameters.nquads(); z++)
+                {
+                    lspec.Jlin[p][k] += lspec.quadrature.weights[z] * radiation.J(p, freq_nrs[z]);
+                }
+
+
+                double diff = 0.0;
+
+                // Collect the approximated part
                 for (Size m = 0; m < lspec.lambda.get_size(p,k); m++)
                 {
                     const Size I = lspec.index(lspec.lambda.get_nr(p,k,m), lspec.linedata.irad[k]);
@@ -423,8 +845,12 @@ int Model :: compute_level_populations (
         // Start assuming convergence
         some_not_converged = false;
 
+        profiler.start_iteration();
+
         if (use_Ng_acceleration && (iteration_normal == 4))
         {
+            Profiler::Stage stage (profiler, "ng_acceleration");
+
             lines.iteration_using_Ng_acceleration (parameters.pop_prec());
 
             iteration_normal = 0;
@@ -434,17 +860,51 @@ int Model :: compute_level_populations (
             // logger.write ("Computing the radiation field...");
             cout << "Computing the radiation field..." << endl;
 
-            compute_radiation_field_feautrier_order_2 ();
-            compute_Jeff                              ();
+            {
+                Profiler::Stage stage (profiler, "radiation_field");
+                compute_radiation_field_feautrier_order_2 ();
+            }
+            {
+                Profiler::Stage stage (profiler, "compute_Jeff");
+                compute_Jeff ();
+            }
+            {
+                Profiler::Stage stage (profiler, "statistical_equilibrium");
 
-            lines.iteration_using_statistical_equilibrium (
-                chemistry.species.abundance,
-                thermodynamics.temperature.gas,
-                parameters.pop_prec()                     );
+                lines.iteration_using_statistical_equilibrium (
+                    chemistry.species.abundance,
+                    thermodynamics.temperature.gas,
+                    parameters.pop_prec(),
+                    geometry.points.multiscale.get_mask()     );
+            }
+
+            // Break down the statistical equilibrium per species
+            // (its work is counted here, that of the solver in the solver)
+            WorkCounters stateq_counters;
+
+            for (Size l = 0; l < parameters.nlspecs(); l++)
+            {
+                const LineProducingSpecies& lspec = lines.lineProducingSpecies[l];
+
+                profiler.add ("triplet_assembly",  l, lspec.time_assembly     );
+                profiler.add ("factorisation",     l, lspec.time_factorisation);
+                profiler.add ("solve",             l, lspec.time_solve        );
+                profiler.add ("convergence_check", l, lspec.time_convergence  );
+
+                stateq_counters.count (WorkCounters::RateNonZeros, lspec.RT.nonZeros());
+            }
+
+            stateq_counters.aggregate (counters);
 
             iteration_normal++;
         }
 
+        // Fill in the points that are not in the current (coarse) grid
+        if (geometry.points.multiscale.curr_lvl > 0)
+        {
+            prolongate_level_populations (geometry.points.multiscale.curr_lvl);
+        }
+
 
         for (int l = 0; l < parameters.nlspecs(); l++)
         {
@@ -470,12 +930,164 @@ int Model :: compute_level_populations (
 }
 
 
+///  Build a hierarchy of coarsened grids for the multigrid solver
+///    @param[in] n_levels : requested number of coarser levels
+///    @return number of coarser levels that were created
+//////////////////////////////////////////////////////////////////
+int Model :: coarsen_grid (const Size n_levels)
+{
+    return geometry.coarsen (n_levels);
+}
+
+
+///  Prolongate the level populations from a coarse level to all points that
+///  are not in that level, and update the emissivities and opacities.
+///    @param[in] lvl : coarse level from which to prolongate
+////////////////////////////////////////////////////////////////////////////
+int Model :: prolongate_level_populations (const Size lvl)
+{
+    for (LineProducingSpecies &lspec : lines.lineProducingSpecies)
+    {
+        geometry.points.multiscale.prolongate (
+            lvl,
+            geometry.points.position,
+            lspec.linedata.nlev,
+            lspec.population         );
+
+        // Redo the convergence check, now including the prolongated values
+        lspec.check_for_convergence (parameters.pop_prec());
+    }
+
+    lines.set_emissivity_and_opacity ();
+
+    return (0);
+}
+
+
+///  Compute level populations with a multigrid scheme: converge first on the
+///  coarsest grid, then use the prolongated result as initial guess on each
+///  finer grid (nested iteration). Optionally this is followed by coarse-grid
+///  correction cycles, in which the change of the coarse-grid solution is
+///  prolongated and added to the fine-grid solution.
+///    @param[in] use_Ng_acceleration : true if Ng acceleration has to be used
+///    @param[in] max_niterations     : maximum number of iterations per level
+///    @param[in] n_cycles            : number of coarse-grid correction cycles
+///    @return total number of iterations done (over all levels)
+///////////////////////////////////////////////////////////////////////////////
+int Model :: compute_level_populations_multigrid (
+    const bool use_Ng_acceleration,
+    const long max_niterations,
+    const Size n_cycles            )
+{
+    Multiscale& multiscale = geometry.points.multiscale;
+
+    if (multiscale.get_n_levels() < 2)
+    {
+        throw std::runtime_error ("No coarser grids available, call coarsen_grid first!");
+    }
+
+    const Size coarsest = multiscale.get_n_levels() - 1;
+
+    int iteration_tot = 0;
+
+    // Nested iteration, from the coarsest to the original grid
+    for (long lvl = coarsest; lvl >= 0; lvl--)
+    {
+        cout << "Multigrid: level " << lvl << " ("
+             << multiscale.get_n_points (lvl) << " points)" << endl;
+
+        geometry.set_coarsening_level (lvl);
+
+        iteration_tot += compute_level_populations (use_Ng_acceleration, max_niterations);
+    }
+
+    // Coarse-grid correction cycles
+    for (Size c = 0; c < n_cycles; c++)
+    {
+        cout << "Multigrid: correction cycle " << c << endl;
+
+        // Store the difference between the fine-grid solution and the
+        // prolongation of its restriction (injection) to the coarse grid
+        VectorXr1 correction (parameters.nlspecs());
+
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+            VectorXr restricted = lspec.population;
+
+            multiscale.prolongate (coarsest, geometry.points.position, lspec.linedata.nlev, restricted);
+
+            correction[l] = lspec.population - restricted;
+        }
+
+        geometry.set_coarsening_level (coarsest);
+
+        iteration_tot += compute_level_populations (use_Ng_acceleration, max_niterations);
+
+        // Add the correction per point, damped such that no population of the
+        // point becomes negative, and renormalise to the total population
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+            threaded_for (p, parameters.npoints(),
+            {
+                Real alpha = 1.0;
+
+                for (Size i = 0; i < lspec.linedata.nlev; i++)
+                {
+                    const Size I = lspec.index (p, i);
+
+                    if (lspec.population[I] + correction[l][I] <= 0.0)
+                    {
+                        alpha = std::min (alpha, 0.9 * lspec.population[I] / (-correction[l][I]));
+                    }
+                }
+
+                Real total = 0.0;
+
+                for (Size i = 0; i < lspec.linedata.nlev; i++)
+                {
+                    const Size I = lspec.index (p, i);
+
+                    lspec.population[I] += alpha * correction[l][I];
+
+                    total += lspec.population[I];
+                }
+
+                if (total > 0.0)
+                {
+                    for (Size i = 0; i < lspec.linedata.nlev; i++)
+                    {
+                        lspec.population[lspec.index (p, i)] *= lspec.population_tot[p] / total;
+                    }
+                }
+            })
+        }
+
+        lines.set_emissivity_and_opacity ();
+
+        geometry.set_coarsening_level (0);
+
+        iteration_tot += compute_level_populations (use_Ng_acceleration, max_niterations);
+    }
+
+    cout << "Multigrid: " << iteration_tot << " iterations in total" << endl;
+
+    return iteration_tot;
+}
+
+
 ///  Computer for the radiation field
 /////////////////////////////////////
 int Model :: compute_image (const Size ray_nr)
 {
     cout << "Computing image..." << endl;
 
+    // Recompute whatever became stale since the last solve
+    update ();
+
     // const Size length_max = 4*parameters.npoints() + 1;
     // const Size  width_max =   parameters.nfreqs ();
 
@@ -503,5 +1115,418 @@ int Model :: set_boundary_condition ()
     Solver solver;
     solver.set_boundary_condition (*this);
 
+    dependencies.mark_computed (Q_BoundaryCondition);
+
     return (0);
 }
+
+
+///  Compute level populations with the Sobolev or large velocity gradient (LVG)
+///  approximation. The mean intensity in each line is replaced by its local
+///  escape probability estimate, J = (1-beta) S + beta I_bg, such that no formal
+///  solution is required. This is useful as a quick preview of a model, or as an
+///  initial guess for the (ALI) level populations computed with a full solver.
+///  The (1-beta) S part is treated exactly, as a local approximated lambda operator.
+///    @param[in] max_niterations : maximum number of iterations
+///    @return number of iterations done
+///////////////////////////////////////////////////////////////////////////////////
+int Model :: compute_level_populations_sobolev (const long max_niterations)
+{
+    // Velocity gradient tensors, these do not change during the iterations
+    vector<Eigen::Matrix3d> gradient (parameters.npoints());
+
+    threaded_for (p, parameters.npoints(),
+    {
+        gradient[p] = geometry.get_velocity_gradient (p);
+    })
+
+    // Make sure emissivities and opacities correspond to the current populations
+    lines.set_emissivity_and_opacity ();
+
+    // Initialize the number of iterations
+    int iteration = 0;
+
+    // Initialize some_not_converged
+    bool some_not_converged = true;
+
+    // Iterate as long as some levels are not converged
+    while (some_not_converged && (iteration < max_niterations))
+    {
+        iteration++;
+
+        cout << "Starting Sobolev iteration " << iteration << endl;
+
+        // Start assuming convergence
+        some_not_converged = false;
+
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+            lspec.lambda.clear();
+
+            threaded_for (p, parameters.npoints(),
+            {
+                for (Size k = 0; k < lspec.linedata.nrad; k++)
+                {
+                    const Size lid = lines.line_index (l, k);
+                    const Real eta = lines.emissivity (p, lid);
+                    const Real chi = lines.opacity    (p, lid);
+                    const Real frq = lspec.linedata.frequency[k];
+
+                    // Angle-averaged escape probability, with Sobolev optical
+                    // depth tau = chi / (nu |d(v/c)/ds|), since the opacity is
+                    // integrated over frequency and the gradient is in units of c.
+                    Real b = 0.0;
+
+                    for (Size r = 0; r < parameters.nrays(); r++)
+                    {
+                        const Vector3D        d = geometry.rays.direction[r];
+                        const Eigen::Vector3d n (d.x(), d.y(), d.z());
+
+                        const Real dvds = fabs (n.dot (gradient[p] * n));
+
+                        if (dvds > 0.0)
+                        {
+                            const Real tau = chi / (frq * dvds);
+
+                            b += geometry.rays.weight[r] * ((tau < 1.0e-5) ? 1.0 - 0.5 * tau : -expm1 (-tau) / tau);
+                        }
+                    }
+
+                    // Background radiation field (CMB)
+                    const Real I_bg = TWO_HH_OVER_CC_SQUARED * (frq*frq*frq)
+                                      / expm1 (HH_OVER_KB * frq / T_CMB);
+
+                    // Local approximated lambda operator (1-beta) A / chi,
+                    // with the resulting source function (1-beta) eta / chi.
+                    Real Ls = 0.0;
+
+                    if (chi > 0.0)
+                    {
+                        Ls = (1.0 - b) * lspec.linedata.A[k] / chi;
+
+                        lspec.lambda.add_element (p, k, p, Ls);
+                    }
+
+                    const Size I = lspec.index (p, lspec.linedata.irad[k]);
+
+                    lspec.Jlin[p][k] = ((chi > 0.0) ? (1.0 - b) * eta / chi : 0.0) + b * I_bg;
+                    lspec.Jdif[p][k] = HH_OVER_FOUR_PI * Ls * lspec.population[I];
+                    lspec.Jeff[p][k] = lspec.Jlin[p][k] - lspec.Jdif[p][k];
+                }
+            })
+        }
+
+        lines.iteration_using_statistical_equilibrium (
+            chemistry.species.abundance,
+            thermodynamics.temperature.gas,
+            parameters.pop_prec()                     );
+
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            const double fnc = lines.lineProducingSpecies[l].fraction_not_converged;
+
+            if (fnc > 0.005)
+            {
+                some_not_converged = true;
+            }
+
+            cout << "Already " << 100 * (1.0 - fnc) << " % converged!" << endl;
+        }
+    }
+
+    // The local lambda operator is meaningless for subsequent formal solutions
+    for (LineProducingSpecies &lspec : lines.lineProducingSpecies)
+    {
+        lspec.lambda.clear();
+    }
+
+    cout << "Sobolev converged after " << iteration << " iterations" << endl;
+
+    return iteration;
+}
+
+
+///  Compute level populations with a Jacobian-free Newton-Krylov (JFNK) method.
+///  The unknowns are the level populations of all species and the residual is
+///  the change in a single ALI step, F(x) = x - G(x), in which G is a formal
+///  solution followed by a solve of the statistical equilibrium equations with
+///  the approximated lambda operator. Hence, the ALO and the rate matrices act
+///  as a (nonlinear) preconditioner. Jacobian-vector products are approximated
+///  with finite differences, such that every Krylov iteration costs one formal
+///  solution. The linear systems are solved with (unrestarted) GMRES.
+///    @param[in] max_niterations : maximum number of Newton iterations
+///    @param[in] max_krylov_dim  : maximum dimension of the Krylov subspace
+///    @return number of Newton iterations done
+//////////////////////////////////////////////////////////////////////////////////
+int Model :: compute_level_populations_newton_krylov (
+    const long max_niterations,
+    const Size max_krylov_dim  )
+{
+    // Check spectral discretisation setting
+    if (spectralDiscretisation != SD_Lines)
+    {
+        throw std::runtime_error ("Spectral discretisation was not set for Lines!");
+    }
+
+    // Inexact Newton forcing term (relative tolerance for GMRES)
+    const Real eta = 1.0e-1;
+
+    // Offsets of the populations of each species in the vector of unknowns
+    Size1 offset (parameters.nlspecs()+1, 0);
+
+    for (Size l = 0; l < parameters.nlspecs(); l++)
+    {
+        offset[l+1] = offset[l] + lines.lineProducingSpecies[l].population.size();
+    }
+
+    const Size N = offset[parameters.nlspecs()];
+
+    auto get_populations = [&] (VectorXr& x)
+    {
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            const LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+            x.segment (offset[l], lspec.population.size()) = lspec.population;
+        }
+    };
+
+    auto set_populations = [&] (const VectorXr& x)
+    {
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+            lspec.population = x.segment (offset[l], lspec.population.size());
+        }
+    };
+
+    // Populations are scaled with their values at the start of each Newton
+    // iteration, since they typically span many orders of magnitude.
+    VectorXr scale (N);
+
+    auto set_scale = [&] (const VectorXr& x)
+    {
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            const LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+            threaded_for (p, parameters.npoints(),
+            {
+                const Real min_pop = 1.0E-10 * lspec.population_tot[p];
+
+                for (Size i = 0; i < lspec.linedata.nlev; i++)
+                {
+                    const Size I = offset[l] + lspec.index (p, i);
+
+                    scale[I] = std::max (x[I], min_pop);
+
+                    if (scale[I] <= 0.0) {scale[I] = 1.0;}
+                }
+            })
+        }
+    };
+
+    // Residual of a single ALI step in the scaled variables (one formal solution)
+    auto residual = [&] (const VectorXr& y, VectorXr& F)
+    {
+        set_populations (scale.cwiseProduct (y));
+
+        lines.set_emissivity_and_opacity ();
+
+        compute_radiation_field_feautrier_order_2 ();
+        compute_Jeff                              ();
+
+        for (LineProducingSpecies &lspec : lines.lineProducingSpecies)
+        {
+            lspec.solve_statistical_equilibrium (
+                chemistry.species.abundance,
+                thermodynamics.temperature.gas );
+        }
+
+        VectorXr g (N);
+        get_populations (g);
+
+        F = y - g.cwiseQuotient (scale);
+    };
+
+    // Initialize counters and errors
+    const Size n_formal_solutions_start = n_formal_solutions;
+
+    n_krylov_iterations = 0;
+
+    error_mean.clear ();
+    error_max .clear ();
+
+    VectorXr x (N);
+    VectorXr F (N);
+    VectorXr Fv(N);
+
+    int  iteration          = 0;
+    bool some_not_converged = true;
+
+    // Iterate as long as some levels are not converged
+    while (some_not_converged && (iteration < max_niterations))
+    {
+        iteration++;
+
+        cout << "Starting Newton iteration " << iteration << endl;
+
+        get_populations (x);
+        set_scale       (x);
+
+        const VectorXr y = VectorXr::Ones (N);
+
+        residual (y, F);
+
+        const Real F_norm = F.norm();
+
+        cout << "Residual norm = " << F_norm << endl;
+
+        VectorXr dy = VectorXr::Zero (N);
+
+        if (F_norm > 0.0)
+        {
+            // GMRES for J dy = -F, with a finite difference step for unit vectors
+            const Real fd_step = sqrt ((1.0 + y.norm()) * std::numeric_limits<double>::epsilon());
+
+            vector<VectorXr> V;
+            MatrixXr H  = MatrixXr::Zero (max_krylov_dim+1, max_krylov_dim);
+            VectorXr cs = VectorXr::Zero (max_krylov_dim);
+            VectorXr sn = VectorXr::Zero (max_krylov_dim);
+            VectorXr g  = VectorXr::Zero (max_krylov_dim+1);
+
+            V.push_back (-F / F_norm);
+            g[0] = F_norm;
+
+            Size j = 0;
+
+            while (j < max_krylov_dim)
+            {
+                // Finite difference approximation of the Jacobian-vector product
+                residual (y + fd_step * V[j], Fv);
+
+                VectorXr w = (Fv - F) / fd_step;
+
+                // Below this, the new direction is (numerically) in the Krylov space
+                const Real h_tol = std::numeric_limits<double>::epsilon() * w.norm();
+
+                // Modified Gram-Schmidt orthogonalisation
+                for (Size i = 0; i <= j; i++)
+                {
+                    H(i,j) = w.dot (V[i]);
+                    w     -= H(i,j) * V[i];
+                }
+
+                const Real h_next = w.norm();
+
+                H(j+1,j) = h_next;
+
+                // Apply the previous Givens rotations to the new column
+                for (Size i = 0; i < j; i++)
+                {
+                    const Real tmp = cs[i]*H(i,j) + sn[i]*H(i+1,j);
+                    H(i+1,j)       = cs[i]*H(i+1,j) - sn[i]*H(i,j);
+                    H(i,  j)       = tmp;
+                }
+
+                // Happy breakdown: the Krylov space is invariant, so the least
+                // squares solution in it is exact. Stop before forming a Givens
+                // rotation with a vanishing subdiagonal element, and only keep
+                // the new column if it does not make the system singular.
+                if (h_next <= h_tol)
+                {
+                    if (fabs (H(j,j)) > h_tol)
+                    {
+                        H(j+1,j) = 0.0;
+                        g[j+1]   = 0.0;
+
+                        j++;
+                        n_krylov_iterations++;
+                    }
+
+                    break;
+                }
+
+                // Compute and apply a new Givens rotation
+                const Real denom = sqrt (H(j,j)*H(j,j) + H(j+1,j)*H(j+1,j));
+
+                cs[j] = H(j,  j) / denom;
+                sn[j] = H(j+1,j) / denom;
+
+                H(j,  j) = denom;
+                H(j+1,j) = 0.0;
+
+                g[j+1] = -sn[j] * g[j];
+                g[j  ] =  cs[j] * g[j];
+
+                j++;
+                n_krylov_iterations++;
+
+                if (fabs (g[j]) <= eta * F_norm) {break;}
+
+                V.push_back (w / h_next);
+            }
+
+            cout << "GMRES relative residual " << fabs (g[j]) / F_norm
+                 << " after " << j << " Krylov iterations" << endl;
+
+            // Solve the upper triangular least squares system and update
+            const VectorXr z = H.topLeftCorner (j, j).triangularView<Eigen::Upper>().solve (g.head (j));
+
+            for (Size i = 0; i < j; i++)
+            {
+                dy += z[i] * V[i];
+            }
+        }
+
+        // Damp the Newton step to keep all populations positive
+        Real damping = 1.0;
+
+        for (Size I = 0; I < N; I++)
+        {
+            if (dy[I] < 0.0)
+            {
+                damping = std::min (damping, -0.9 * y[I] / dy[I]);
+            }
+        }
+
+        // If the Newton step is strongly damped, fall back to an ALI step,
+        // i.e. the G(x) that was computed for the residual in this iteration.
+        const VectorXr y_new = (damping < 0.1) ? VectorXr (y - F) : VectorXr (y + damping * dy);
+
+        set_populations (scale.cwiseProduct (y_new));
+
+        // Start assuming convergence
+        some_not_converged = false;
+
+        for (Size l = 0; l < parameters.nlspecs(); l++)
+        {
+            LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+            lspec.population_prev1 = x.segment (offset[l], lspec.population.size());
+
+            lspec.check_for_convergence (parameters.pop_prec());
+
+            error_mean.push_back (lspec.relative_change_mean);
+            error_max .push_back (lspec.relative_change_max);
+
+            if (lspec.fraction_not_converged > 0.005)
+            {
+                some_not_converged = true;
+            }
+
+            cout << "Already " << 100 * (1.0 - lspec.fraction_not_converged) << " % converged!" << endl;
+        }
+    }
+
+    lines.set_emissivity_and_opacity ();
+
+    cout << "Newton-Krylov converged after " << iteration           << " Newton iterations, "
+         << n_krylov_iterations                                     << " Krylov iterations and "
+         << n_formal_solutions - n_formal_solutions_start           << " formal solutions"     << endl;
+
+    return iteration;
+}
@@ -1,10 +1,17 @@
 #pragma once
 
 
+#include "../configure.hpp"
 #include "io/io.hpp"
 #include "io/python/io_python.hpp"
+#if (HDF5_IO)
+#include "io/cpp/io_cpp_hdf5.hpp"
+#endif
 #include "parameters/parameters.hpp"
 #include "tools/types.hpp"
+#include "tools/dependencyGraph.hpp"
+#include "tools/timer.hpp"
+#include "tools/counters.hpp"
 #include "geometry/geometry.hpp"
 #include "chemistry/chemistry.hpp"
 #include "thermodynamics/thermodynamics.hpp"
@@ -13,10 +20,19 @@
 #include "image/image.hpp"
 
 
+///  Model: a model and everything to solve for its radiation field.
+///  Copies of a model share their parameters and their geometry, e.g. the
+///  variants in an Ensemble, which only differ in their other (physical)
+///  quantities. The geometry is held through a shared pointer, geometry is
+///  a reference to it, which in a copy refers to the same geometry.
+////////////////////////////////////////////////////////////////////////////
 struct Model
 {
-    Parameters     parameters;
-    Geometry       geometry;
+    Parameters     parameters;   ///< own parameters (shared by all parts)
+
+    std::shared_ptr<Geometry> shared_geometry = std::make_shared<Geometry>();   ///< geometry (shared between copies)
+    Geometry&                 geometry        = *shared_geometry;              ///< reference to the (shared) geometry
+
     Chemistry      chemistry;
     Thermodynamics thermodynamics;
     Lines          lines;
@@ -26,30 +42,71 @@ struct Model
     enum SpectralDiscretisation {None, SD_Lines, SD_Image}
          spectralDiscretisation = None;
 
-    Model () {};
+    ///  Quantities of which changes are tracked, the inputs (set through the
+    ///  setters below, or changed directly, which is detected through their
+    ///  fingerprints) and the derived quantities that depend on them
+    //////////////////////////////////////////////////////////////////////////
+    enum Quantity {Q_Geometry, Q_Temperature, Q_Turbulence, Q_LineData, Q_Boundary,
+                   Q_InverseWidths, Q_Frequencies, Q_RayLengths, Q_BoundaryCondition,
+                   Q_PointComponents, n_quantities};
+
+    DependencyGraph dependencies = get_dependency_graph();
+    Size_t1         fingerprints = Size_t1 (n_quantities, 0);   ///< fingerprints of the inputs when last checked
+
+    static DependencyGraph get_dependency_graph ();
+
+    Model () {set_parameters();};
     Model (const string name)
     {
+        set_parameters ();
         parameters.model_name() = name;
         read ();
     }
 
+    void set_parameters ();
+
+    inline Geometry& get_geometry () {return geometry;};
+
     void read  (const Io& io);
     void write (const Io& io) const;
 
+#if (HDF5_IO)
+    void read  ()       {read  (IoHdf5 (parameters.model_name()));};
+    void write () const {write (IoHdf5 (parameters.model_name()));};
+#else
     void read  ()       {read  (IoPython ("hdf5", parameters.model_name()));};
     void write () const {write (IoPython ("hdf5", parameters.model_name()));};
+#endif
+
+    void set_temperature          (const Real1&   temperature);
+    void set_turbulence           (const Real1&   vturb2     );
+    void set_velocity             (const Double2& velocity   );
+    void set_boundary_temperature (const Real1&   temperature);
+    void mark_changed             (const Quantity quantity   );
+    bool is_stale                 (const Quantity quantity   );
+    int  update                   ();
+
+    size_t get_fingerprint        (const Quantity quantity   ) const;
+    void   detect_changes         ();
+
+    int  place_memory_numa        (const bool pin_threads);
+    void report_memory_placement  () const;
 
     int compute_inverse_line_widths               ();
     int compute_spectral_discretisation           ();
+    int compute_spectral_discretisation_merged    (
+        const Real tolerance );
     int compute_spectral_discretisation           (
         const Real width );
     int compute_spectral_discretisation           (
         const long double nu_min,
         const long double nu_max );
+    void compute_line_frequency_grid              (const Real tolerance);
     int compute_LTE_level_populations             ();
     int compute_radiation_field                   ();
     int compute_radiation_field_feautrier_order_2 ();
     int compute_radiation_field_shortchar_order_0 ();
+    int compute_scattered_intensity               ();
     int compute_Jeff                              ();
     int compute_level_populations_from_stateq     ();
     int compute_level_populations                 (
@@ -58,9 +115,27 @@ struct Model
         const long  max_niterations     );
     int compute_image                             (const Size ray_nr);
 
+    int coarsen_grid                              (const Size n_levels);
+    int prolongate_level_populations              (const Size lvl);
+    int compute_level_populations_multigrid       (
+        const bool  use_Ng_acceleration,
+        const long  max_niterations,
+        const Size  n_cycles            );
+    int compute_level_populations_sobolev         (
+        const long  max_niterations     );
+    int compute_level_populations_newton_krylov   (
+        const long  max_niterations,
+        const Size  max_krylov_dim      );
+
     Double1 error_max;
     Double1 error_mean;
 
+    Size n_formal_solutions  = 0;   ///< number of formal solutions (radiation field computations)
+    Size n_krylov_iterations = 0;   ///< number of Krylov iterations in last Newton-Krylov solve
+
+    Profiler profiler;              ///< time spent per stage in each iteration
+    WorkCounters counters;          ///< work done in the solver kernels (with WORK_COUNTERS)
+
     pc::multi_threading::ThreadPrivate<Vector<Real>> a;
     pc::multi_threading::ThreadPrivate<Vector<Real>> b;
     pc::multi_threading::ThreadPrivate<Vector<Real>> c;
@@ -2,6 +2,7 @@
 
 
 #include <limits>
+#include <memory>
 
 #include "io/io.hpp"
 #include "tools/setOnce.hpp"
@@ -10,48 +11,51 @@
 
 
 ///  Create for each parameter "x":
-///    - a (private) local variable "x__",
-///    - a (private) Meyers' singleton for isSet "x_isSet()",
-///    - a (public) Meyers' singleton for value "x()",
-///    - a (public) setter function "set_x".
-///  Remember to ensure in Parameters copy constructor to
-///  ensure that the local variables are up to date, i.e.
-///  ensure that their values equal the global values.
+///    - a (public) getter "x()" for a reference to the value,
+///    - a (public) setter function "set_x",
+///    - a (public) getter function "get_x" for a copy of the value.
+///  The values themselves are kept in the (shared) storage of the
+///  Parameters object, which holds a SetOnce variable "x" for each.
 
 #define CREATE_PARAMETER(type, x)                                                           \
-    private:                                                                                \
-        SetOnce<type> x##__;                     /* Local (SetOnce) variable           */   \
-        accel inline bool& x##_isSet () const    /* Meyers' singleton for global isSet */   \
-        {                                                                                   \
-            static bool isSet = false;           /* Global isSet                       */   \
-            return isSet;                        /* Return global isSet                */   \
-        }                                                                                   \
     public:                                                                                 \
-        accel inline type& x () const            /* Meyers' singleton for global value */   \
+        accel inline type& x () const            /* Reference to value in storage      */   \
         {                                                                                   \
-            static type x##_value;               /* Global value                       */   \
-            if (!x##_isSet())                    /* If global value is not set         */   \
-            {                                                                               \
-                x##_value   = x##__.get();       /* Set global with local value        */   \
-                x##_isSet() = true;              /* Mark global value as set           */   \
-            }                                                                               \
-            return x##_value;                    /* Return global value                */   \
+            return storage->x.ref();                                                        \
         }                                                                                   \
         inline void set_##x (const type value)   /* Setter function                    */   \
         {                                                                                   \
-            x##__.set (value);                   /* Set local value                    */   \
-            x() = value;                         /* Set global value                   */   \
+            storage->x.set (value);              /* Throws if set to another value     */   \
         }                                                                                   \
         inline type get_##x () const             /* Getter function                    */   \
         {                                                                                   \
-            return x();                          /* Return copy of global value        */   \
+            return storage->x.get();             /* Return copy of value               */   \
         }
 
-#define CONSTRUCT_PARAMETER(type, x)                                                        \
-    x##__ = SetOnce <type> (x());
+#define STORE_PARAMETER(type, x)                                                            \
+    SetOnce<type> x;
 
-#define COPY_PARAMETER(x)                                                                   \
-    if (x##_isSet()) x##__.set(x());
+
+///  Create for each setting "x" (which, unlike a parameter, can be changed):
+///    - a (public) getter "x()" for a reference to the value,
+///    - a (public) setter function "set_x",
+///    - a (public) getter function "get_x" for a copy of the value.
+///  The values themselves are kept in the (shared) storage as well.
+
+#define CREATE_SETTING(type, x)                                                             \
+    public:                                                                                 \
+        accel inline type& x () const            /* Reference to value in storage      */   \
+        {                                                                                   \
+            return storage->x;                                                              \
+        }                                                                                   \
+        inline void set_##x (const type value)   /* Setter function                    */   \
+        {                                                                                   \
+            storage->x = value;                  /* Can be set to another value        */   \
+        }                                                                                   \
+        inline type get_##x () const             /* Getter function                    */   \
+        {                                                                                   \
+            return storage->x;                   /* Return copy of value               */   \
+        }
 
 
 
@@ -128,9 +132,43 @@ struct Parameters
 //        accel inline bool adaptive_ray_tracing() const {return adaptive_ray_tracing_.get();}
 
 
-    long n_off_diag = 0;
-
-    double max_width_fraction = 0.5;
+    ///  Storage for the values of the parameters, shared between all
+    ///  copies of a Parameters object (i.e. between all parts of a model)
+    //////////////////////////////////////////////////////////////////////
+    struct Storage
+    {
+        STORE_PARAMETER (string, model_name);
+
+        STORE_PARAMETER (Size, dimension );
+        STORE_PARAMETER (Size, npoints   );
+        STORE_PARAMETER (Size, totnnbs   );
+        STORE_PARAMETER (Size, nrays     );
+        STORE_PARAMETER (Size, hnrays    );
+        STORE_PARAMETER (Size, nrays_red );
+        STORE_PARAMETER (Size, order_min );
+        STORE_PARAMETER (Size, order_max );
+        STORE_PARAMETER (Size, nboundary );
+        STORE_PARAMETER (Size, nfreqs    );
+        STORE_PARAMETER (Size, nspecs    );
+        STORE_PARAMETER (Size, nlspecs   );
+        STORE_PARAMETER (Size, nlines    );
+        STORE_PARAMETER (Size, nquads    );
+
+        STORE_PARAMETER (Real, pop_prec);
+
+        STORE_PARAMETER (bool, use_scattering      );
+        STORE_PARAMETER (bool, use_Ng_acceleration );
+        STORE_PARAMETER (bool, spherical_symmetry  );
+        STORE_PARAMETER (bool, adaptive_ray_tracing);
+
+        long   n_off_diag         = 0;     ///< number of off-diagonals in the approximated Lambda operator
+        double max_width_fraction = 0.5;   ///< maximum Doppler shift between points as fraction of the line width
+        double max_solver_memory  = 0.0;   ///< cap on the ray buffers of all threads in bytes (0: no cap)
+        double alo_drop_tolerance = 0.0;   ///< off-diagonal ALO elements below this fraction of the diagonal are dropped
+        Size   alo_max_elements   = 0;     ///< maximum number of ALO elements per (p,k) (0: no cap)
+    };
+
+    std::shared_ptr<Storage> storage;   ///< values of the parameters (shared between copies)
 
     void read (const Io &io);
     void write(const Io &io) const;
@@ -159,57 +197,24 @@ struct Parameters
     CREATE_PARAMETER (bool, spherical_symmetry  );
     CREATE_PARAMETER (bool, adaptive_ray_tracing);
 
-    Parameters ()
-    {
-        CONSTRUCT_PARAMETER (string, model_name);
-
-        CONSTRUCT_PARAMETER (Size, dimension );
-        CONSTRUCT_PARAMETER (Size, npoints   );
-        CONSTRUCT_PARAMETER (Size, totnnbs   );
-        CONSTRUCT_PARAMETER (Size, nrays     );
-        CONSTRUCT_PARAMETER (Size, hnrays    );
-        CONSTRUCT_PARAMETER (Size, nrays_red );
-        CONSTRUCT_PARAMETER (Size, order_min );
-        CONSTRUCT_PARAMETER (Size, order_max );
-        CONSTRUCT_PARAMETER (Size, nboundary );
-        CONSTRUCT_PARAMETER (Size, nfreqs    );
-        CONSTRUCT_PARAMETER (Size, nspecs    );
-        CONSTRUCT_PARAMETER (Size, nlspecs   );
-        CONSTRUCT_PARAMETER (Size, nlines    );
-        CONSTRUCT_PARAMETER (Size, nquads    );
-
-        CONSTRUCT_PARAMETER (Real, pop_prec);
-
-        CONSTRUCT_PARAMETER (bool, use_scattering      );
-        CONSTRUCT_PARAMETER (bool, use_Ng_acceleration );
-        CONSTRUCT_PARAMETER (bool, spherical_symmetry  );
-        CONSTRUCT_PARAMETER (bool, adaptive_ray_tracing);
-    }
-
-    Parameters (const Parameters& parameters)
-    {
-        COPY_PARAMETER (model_name);
-
-        COPY_PARAMETER (dimension );
-        COPY_PARAMETER (npoints   );
-        COPY_PARAMETER (totnnbs   );
-        COPY_PARAMETER (nrays     );
-        COPY_PARAMETER (hnrays    );
-        COPY_PARAMETER (nrays_red );
-        COPY_PARAMETER (order_min );
-        COPY_PARAMETER (order_max );
-        COPY_PARAMETER (nboundary );
-        COPY_PARAMETER (nfreqs    );
-        COPY_PARAMETER (nspecs    );
-        COPY_PARAMETER (nlspecs   );
-        COPY_PARAMETER (nlines    );
-        COPY_PARAMETER (nquads    );
-
-        COPY_PARAMETER (pop_prec);
-
-        COPY_PARAMETER (use_scattering      );
-        COPY_PARAMETER (use_Ng_acceleration );
-        COPY_PARAMETER (spherical_symmetry  );
-        COPY_PARAMETER (adaptive_ray_tracing);
-    }
+    CREATE_SETTING (long,   n_off_diag        );
+    CREATE_SETTING (double, max_width_fraction);
+    CREATE_SETTING (double, max_solver_memory );
+    CREATE_SETTING (double, alo_drop_tolerance);
+    CREATE_SETTING (Size,   alo_max_elements  );
+
+    ///  Constructor, creates a new (empty) storage. Parts of a model get the
+    ///  parameters of the model (and hence share its storage) explicitly,
+    ///  through their set_parameters.
+    ///////////////////////////////////////////////////////////////////////////
+    Parameters () : storage (std::make_shared<Storage>()) {};
+
+    ///  Copy constructor, the copy shares the storage with the original.
+    ///  Hence, also copies of a model (such as the variants in an Ensemble)
+    ///  share their parameters and settings, which is intended, since they
+    ///  describe the same grid and are solved with the same solver.
+    /////////////////////////////////////////////////////////////////////////
+    Parameters (const Parameters& parameters) = default;
+
+    Parameters& operator= (const Parameters& parameters) = default;
 };
@@ -26,21 +26,65 @@ void Frequencies :: read (const Io& io)
     // Add ncont bins background
     //nfreqs += ncont;
 
-    nu.resize (parameters.npoints(), parameters.nfreqs());
+    resize (1);
+
+    nfreqs_red = parameters.nfreqs();
 
     appears_in_line_integral.resize (parameters.nfreqs());
+    first_component         .resize (parameters.nfreqs()+1, 0);
     corresponding_l_for_spec.resize (parameters.nfreqs());
     corresponding_k_for_tran.resize (parameters.nfreqs());
     corresponding_z_for_line.resize (parameters.nfreqs());
 
     // frequencies.nu has to be initialized (for unused entries)
+    for (Size f = 0; f < parameters.nfreqs(); f++)
+    {
+        nu_centre  [f] = 0.0;
+        nu_offset  [f] = 0.0;
+        width_index[f] = 0;
+    }
+}
+
+
+///  Resize the frequency grid and width factors, the latter are set to zero
+///    @param[in] nwidths : number of width factors per point
+///////////////////////////////////////////////////////////////////////////
+void Frequencies :: resize (const Size nwidths)
+{
+    nu_centre  .resize (parameters.nfreqs());
+    nu_offset  .resize (parameters.nfreqs());
+    width_index.resize (parameters.nfreqs());
+
+    width_factor.resize (parameters.npoints(), nwidths);
+
+    threaded_for (p, parameters.npoints(),
+    {
+        for (Size w = 0; w < nwidths; w++)
+        {
+            width_factor(p, w) = 0.0;
+        }
+    })
+}
+
+
+///  Getter for the full frequency matrix (e.g. for output or in python)
+///    @return [Hz] matrix with the frequency of each bin at each point (p,f)
+/////////////////////////////////////////////////////////////////////////////
+Matrix<Real> Frequencies :: get_nu () const
+{
+    Matrix<Real> nu_full;
+
+    nu_full.resize (parameters.npoints(), parameters.nfreqs());
+
     threaded_for (p, parameters.npoints(),
     {
         for (Size f = 0; f < parameters.nfreqs(); f++)
         {
-            nu(p,f) = 0.0;
+            nu_full(p, f) = nu(p, f);
         }
     })
+
+    return nu_full;
 }
 
 
@@ -51,5 +95,5 @@ void Frequencies :: write (const Io &io) const
 {
     cout << "Writing frequencies..." << endl;
 
-    io.write_array (prefix+"nu", nu);
+    io.write_array (prefix+"nu", get_nu());
 }
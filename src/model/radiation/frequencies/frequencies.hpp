@@ -7,20 +7,45 @@
 #include "model/thermodynamics/temperature/temperature.hpp"
 
 
+///  Frequencies: spectral discretisation
+///  The frequency bins are the same at every point up to a scaling of the
+///  line widths, hence only a shared (sorted) grid is stored, together with
+///  a relative width for each (point, width index) pair, such that
+///    nu(p,f) = nu_centre[f] + nu_offset[f] * width_factor(p, width_index[f])
+///  Bins of different lines that (nearly) coincide can be merged, then only
+///  the first nfreqs_red bins are used, and each bin f corresponds to the
+///  (l,k,z) components first_component[f] up to first_component[f+1].
+///////////////////////////////////////////////////////////////////////////////
 struct Frequencies
 {
     Parameters parameters;
 
-    Matrix<Real> nu;                         ///< [Hz] frequencies (ordered in f) (p,f)
+    Vector<Real> nu_centre;             ///< [Hz] line centre of each frequency bin (f)
+    Vector<Real> nu_offset;             ///< [Hz] offset from the centre per unit width (f)
+    Vector<Size> width_index;           ///< index of the width factor of each bin (f)
+    Matrix<Real> width_factor;          ///< [.] relative width at each point (p,w)
+
+    Size nfreqs_red      = 0;         ///< number of frequency bins in use (after merging)
+    Real merge_tolerance = 0.0;       ///< relative distance below which bins are merged
 
     Bool1 appears_in_line_integral;   ///< True if the frequency appears in line integral
-    Size1 corresponding_l_for_spec;   ///< number of line species corresponding to frequency
-    Size1 corresponding_k_for_tran;   ///< number of transition corresponding to frequency
-    Size1 corresponding_z_for_line;   ///< number of line number corresponding to frequency
+    Size1 first_component;            ///< index of first (l,k,z) of each frequency (f+1)
+    Size1 corresponding_l_for_spec;   ///< number of line species of each (l,k,z) component
+    Size1 corresponding_k_for_tran;   ///< number of transition of each (l,k,z) component
+    Size1 corresponding_z_for_line;   ///< number of quadrature point of each (l,k,z) component
 
     void read  (const Io& io);
     void write (const Io& io) const;
 
+    void resize (const Size nwidths);
+
+    accel inline Real nu (const Size p, const Size f) const;
+
+    Matrix<Real> get_nu () const;
+
 //    Size nbins = 0;    ///< number of extra bins per line
 //    Size ncont = 0;    ///< number of background bins
 };
+
+
+#include "frequencies.tpp"
@@ -0,0 +1,9 @@
+///  Getter for the frequency of a bin at a point
+///    @param[in] p : index of the point
+///    @param[in] f : index of the frequency bin
+///    @return [Hz] frequency of bin f at point p
+////////////////////////////////////////////////
+accel inline Real Frequencies :: nu (const Size p, const Size f) const
+{
+    return nu_centre[f] + nu_offset[f] * width_factor(p, width_index[f]);
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 #include "radiation.hpp"
 #include "tools/constants.hpp"
@@ -18,7 +19,9 @@ void Radiation :: read (const Io& io)
 
     if (parameters.use_scattering())
     {
-        cout << "Using scattering, make sure you have enough memory!" << endl;
+        cout << "Using scattering!" << endl;
+
+        scattering.read (io);
     }
     else
     {
@@ -55,23 +58,10 @@ void Radiation :: read (const Io& io)
         // I[r].resize (parameters.npoints(), parameters.nfreqs());
     // }
 
+    // Scattered intensity (per ray pair, at the same resolution as u)
     if (parameters.use_scattering())
     {
-
-        // u.resize (parameters.nrays_red());
-        // v.resize (parameters.nrays_red());
-
-        // U.resize (parameters.nrays_red());
-        // V.resize (parameters.nrays_red());
-
-        for (Size r = 0; r < parameters.nrays_red(); r++)
-        {
-            // u[r].resize (parameters.npoints(), parameters.nfreqs());
-//            v[r].resize (npoints, nfreqs_red);
-
-//            U[r].resize (npoints, nfreqs_red);
-//            V[r].resize (npoints, nfreqs_red);
-        }
+        U.resize (parameters.hnrays(), parameters.npoints(), parameters.nfreqs());
     }
 }
 
@@ -85,6 +75,11 @@ void Radiation :: write (const Io &io) const
 
     frequencies.write (io);
 
+    if (parameters.use_scattering())
+    {
+        scattering.write (io);
+    }
+
 
 //    Double2 JJ (ncells, Double1 (nfreqs));
 //
@@ -243,6 +238,108 @@ void initialize (Real1 &vec)
 }
 
 
+///  Keep u and v out of core, i.e. in files, such that only one slab (one
+///  ray direction) of each is kept in memory. The solvers store every slab
+///  as soon as the corresponding ray direction is finished.
+///    @param[in] file_name : base name of the files (.u and .v are appended)
+////////////////////////////////////////////////////////////////////////////
+void Radiation :: set_out_of_core (const string file_name)
+{
+    cout << "Keeping u and v out of core in " << file_name << ".{u,v}" << endl;
+
+    // The files are shared by all processes (each stores its own rays), so
+    // they are created (truncated) only once, before anyone stores a slab
+    if (pc::message_passing::comm_rank() == 0)
+    {
+        u_on_disk.create (file_name + ".u", parameters.hnrays(), parameters.npoints(), parameters.nfreqs());
+        v_on_disk.create (file_name + ".v", parameters.hnrays(), parameters.npoints(), parameters.nfreqs());
+    }
+    else
+    {
+        u_on_disk.attach (file_name + ".u", parameters.hnrays(), parameters.npoints(), parameters.nfreqs());
+        v_on_disk.attach (file_name + ".v", parameters.hnrays(), parameters.npoints(), parameters.nfreqs());
+    }
+
+#if (MPI_PARALLEL)
+    MPI_Barrier (MPI_COMM_WORLD);
+#endif
+
+    u.resize (1, parameters.npoints(), parameters.nfreqs());
+    v.resize (1, parameters.npoints(), parameters.nfreqs());
+
+    out_of_core = true;
+}
+
+
+///  Store the slab of u and v for ray r (only if they are out of core)
+///    @param[in] r       : number of the (finished) ray
+///    @param[in] store_v : false if v was not computed (e.g. by Feautrier)
+///////////////////////////////////////////////////////////////////////////
+void Radiation :: store_slab (const Size r, const bool store_v)
+{
+    if (!out_of_core) {return;}
+
+    u.copy_ptr_to_vec ();
+    u_on_disk.write_slab (r, u.vec.data());
+
+    if (store_v)
+    {
+        v.copy_ptr_to_vec ();
+        v_on_disk.write_slab (r, v.vec.data());
+    }
+}
+
+
+///  Getter for the u intensity along ray r, from memory or from disk
+///    @param[in] r : number of the ray
+///    @return u intensity for ray r (p, f)
+/////////////////////////////////////////////////////////////////////
+Matrix<Real> Radiation :: get_u_slab (const Size r) const
+{
+    Matrix<Real> slab;
+    slab.resize (parameters.npoints(), parameters.nfreqs());
+
+    if (out_of_core)
+    {
+        u_on_disk.read_slab (r, slab.vec.data());
+    }
+    else
+    {
+        std::copy (u.vec.begin() +  r   *slab.vec.size(),
+                   u.vec.begin() + (r+1)*slab.vec.size(), slab.vec.begin());
+    }
+
+    slab.copy_vec_to_ptr ();
+
+    return slab;
+}
+
+
+///  Getter for the v intensity along ray r, from memory or from disk
+///    @param[in] r : number of the ray
+///    @return v intensity for ray r (p, f)
+/////////////////////////////////////////////////////////////////////
+Matrix<Real> Radiation :: get_v_slab (const Size r) const
+{
+    Matrix<Real> slab;
+    slab.resize (parameters.npoints(), parameters.nfreqs());
+
+    if (out_of_core)
+    {
+        v_on_disk.read_slab (r, slab.vec.data());
+    }
+    else
+    {
+        std::copy (v.vec.begin() +  r   *slab.vec.size(),
+                   v.vec.begin() + (r+1)*slab.vec.size(), slab.vec.begin());
+    }
+
+    slab.copy_vec_to_ptr ();
+
+    return slab;
+}
+
+
 void Radiation :: initialize_J ()
 {
     for (Size p = 0; p < parameters.npoints(); p++)
@@ -255,21 +352,26 @@ void Radiation :: initialize_J ()
 }
 
 
-/// calc_J: integrate mean intensity and "flux over all directions
-//////////////////////////////////////////////////////////////////
+///  Sum the mean intensity over all processes (that each solved for a
+///  share of the rays)
+///////////////////////////////////////////////////////////////////////
 void Radiation :: MPI_reduce_J ()
 
 #if (MPI_PARALLEL)
 
 {
+    J.copy_ptr_to_vec ();
+
     int ierr = MPI_Allreduce (
                   MPI_IN_PLACE,      // pointer to data to be reduced -> here in place
-                  J.data(),          // pointer to data to be received
-                  J.size(),          // size of data to be received
-                  MPI_DOUBLE,        // type of reduced data
+                  J.vec.data(),      // pointer to data to be received
+                  J.vec.size(),      // size of data to be received
+                  MPI_LONG_DOUBLE,   // type of reduced data
                   MPI_SUM,           // reduction operation
                   MPI_COMM_WORLD);
     assert (ierr == 0);
+
+    J.copy_vec_to_ptr ();
 }
 
 #else
@@ -283,89 +385,60 @@ void Radiation :: MPI_reduce_J ()
 
 
 
-/// calc_U_and_V: integrate scattering quantities over all directions
-/////////////////////////////////////////////////////////////////////
-void Radiation :: calc_U_and_V ()
+///  Compute the (even part of the) scattered intensity for every ray pair,
+///  U(r1) = sum_r2 w_r2 [phase(r1.r2) + phase(-r1.r2)] u(r2), from the u of
+///  the last formal solution. The phase function is evaluated on the fly.
+///  (The odd part, from v, does not enter the 2nd-order Feautrier source.)
+///    @param[in] rays : ray directions and weights
+///////////////////////////////////////////////////////////////////////////
+void Radiation :: calc_U (const Rays& rays)
+{
+    U.resize (parameters.hnrays(), parameters.npoints(), parameters.nfreqs());
 
-#if (MPI_PARALLEL)
+    for (Size i = 0; i < U.vec.size(); i++) {U.vec[i] = 0.0;}
 
-{
-//    Real1 U_local (parameters.npoints()*parameters.nfreqs());
-//    Real1 V_local (parameters.npoints()*parameters.nfreqs());
-//
-//    for (Size w = 0; w < pc::message_passing::comm_size(); w++)
-//    {
-//        const Size start = ( w   *(parameters.hnrays())) / pc::message_passing::comm_size();
-//        const Size stop  = ((w+1)*(parameters.hnrays())) / pc::message_passing::comm_size();
-//
-//        for (Size r1 = start; r1 < stop; r1++)
-//        {
-//            const Size R1 = r1 - start;
-//
-//            initialize (U_local);
-//            initialize (V_local);
-//
-//            distributed_for (r2, R2, parameters.hnrays(),
-//            {
-//                threaded_for (p, parameters.npoints(),
-//                {
-//                    for (Size f = 0; f < parameters.nfreqs(); f++)
-//              	    {
-//                        U_local[index(p,f)] += u[R2][index(p,f)]; // * scattering.phase[r1][r2][f];
-//                        V_local[index(p,f)] += v[R2][index(p,f)]; // * scattering.phase[r1][r2][f];
-//                    }
-//                })
-//            }) // end of r2 loop over raypairs2
-//
-//            int ierr_u = MPI_Reduce (
-//                           U_local.data(),     // pointer to the data to be reduced
-//                           U[R1].data(),       // pointer to the data to be received
-//                           U_local.size(),     // size of the data to be received
-//                           MPI_DOUBLE,         // type of the reduced data
-//                           MPI_SUM,            // reduction operation
-//                           w,                  // rank of root to which we reduce
-//                           MPI_COMM_WORLD);
-//            assert (ierr_u == 0);
-//
-//            int ierr_v = MPI_Reduce (
-//                           V_local.data(),     // pointer to the data to be reduced
-//                           V[R1].data(),       // pointer to the data to be received
-//                           V_local.size(),     // size of the data to be received
-//                           MPI_DOUBLE,         // type of the reduced data
-//                           MPI_SUM,            // reduction operation
-//                           w,                  // rank of root to which we reduce
-//                           MPI_COMM_WORLD);
-//            assert (ierr_v == 0);
-//        }
-//    }
-}
+    Real1 phase_even (parameters.hnrays());
 
-#else
+    // Accumulate one (possibly out-of-core) slab of u at a time, for the
+    // rays that were solved for by this process
+    for (Size r2 = pc::message_passing::start (parameters.hnrays());
+              r2 < pc::message_passing::stop  (parameters.hnrays()); r2++)
+    {
+        const Matrix<Real> u2 = get_u_slab (r2);
 
-{
-//    Real1 U_local (parameters.npoints()*parameters.nfreqs());
-//    Real1 V_local (parameters.npoints()*parameters.nfreqs());
+        for (Size r1 = 0; r1 < parameters.hnrays(); r1++)
+        {
+            const Real cos_angle = rays.direction[r1].dot (rays.direction[r2]);
 
-//    for (Size r1 = 0; r1 < parameters.hnrays(); r1++)
-//    {
-//        initialize (U_local);
-//        initialize (V_local);
+            phase_even[r1] = rays.weight[r2] * (  scattering.phase ( cos_angle)
+                                                + scattering.phase (-cos_angle) );
+        }
 
-//        for (Size r2 = 0; r2 < parameters.hnrays(); r2++)
-//        {
-//            threaded_for (p, parameters.npoints(),
-//            {
-//                for (Size f = 0; f < parameters.nfreqs(); f++)
-//                {
-//                    U_local[index(p,f)] += u[r2][index(p,f)]; // * scattering.phase[r1][r2][f];
-//                    V_local[index(p,f)] += v[r2][index(p,f)]; // * scattering.phase[r1][r2][f];
-//                }
-//            })
-//        }
+        threaded_for (p, parameters.npoints(),
+        {
+            for (Size r1 = 0; r1 < parameters.hnrays(); r1++)
+            {
+                for (Size f = 0; f < parameters.nfreqs(); f++)
+                {
+                    U.vec[index (p, f) + r1*parameters.npoints()*parameters.nfreqs()]
+                        += phase_even[r1] * u2.vec[index (p, f)];
+                }
+            }
+        })
+    }
 
-//        U[r1] = U_local;
-//        V[r1] = V_local;
-//    }
-}
+#if (MPI_PARALLEL)
+
+    int ierr = MPI_Allreduce (
+                  MPI_IN_PLACE,      // pointer to data to be reduced -> here in place
+                  U.vec.data(),      // pointer to data to be received
+                  U.vec.size(),      // size of data to be received
+                  MPI_LONG_DOUBLE,   // type of reduced data
+                  MPI_SUM,           // reduction operation
+                  MPI_COMM_WORLD);
+    assert (ierr == 0);
 
 #endif
+
+    U.copy_vec_to_ptr ();
+}
@@ -3,6 +3,8 @@
 
 #include "io/io.hpp"
 #include "tools/types.hpp"
+#include "model/geometry/rays/rays.hpp"
+#include "tools/outOfCoreTensor.hpp"
 #include "frequencies/frequencies.hpp"
 #include "scattering/scattering.hpp"
 
@@ -20,6 +22,11 @@ struct Radiation
     Tensor<Real> u;         ///< intensity (r, p, f)
     Tensor<Real> v;         ///< intensity (r, p, f)
     Matrix<Real> J;         ///< (angular) mean intensity (p, f)
+    Tensor<Real> U;         ///< scattered intensity, even part (r, p, f), only with scattering
+
+    bool                  out_of_core = false;   ///< true if u and v are kept on disk
+    OutOfCoreTensor<Real> u_on_disk;             ///< u on disk (r, p, f), if out of core
+    OutOfCoreTensor<Real> v_on_disk;             ///< v on disk (r, p, f), if out of core
 
     // vector<Matrix<Real>> u;         ///< u intensity             (r, index(p,f))
     // vector<Matrix<Real>> v;         ///< v intensity             (r, index(p,f))
@@ -33,6 +40,17 @@ struct Radiation
     void read  (const Io& io);
     void write (const Io& io) const;
 
+    ///  Set the parameters of the radiation and its parts
+    ///    @param[in] params : parameters of the model
+    //////////////////////////////////////////////////////
+    inline void set_parameters (const Parameters& params)
+    {
+        parameters = params;
+
+        frequencies.parameters = params;
+        scattering .parameters = params;
+    }
+
     inline Size index (const Size p, const Size f) const;
     inline Size index (const Size p, const Size f, const Size m) const;
 
@@ -47,9 +65,17 @@ struct Radiation
 
     inline Real get_J (const Size p, const Size f) const;
 
+    void set_out_of_core (const string file_name);
+    void store_slab      (const Size r, const bool store_v = true);
+
+    Matrix<Real> get_u_slab (const Size r) const;
+    Matrix<Real> get_v_slab (const Size r) const;
+
+    accel inline Size resident_slab (const Size r) const;
+
     void initialize_J ();
     void MPI_reduce_J ();
-    void calc_U_and_V ();
+    void calc_U       (const Rays& rays);
 };
 
 
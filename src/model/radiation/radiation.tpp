@@ -19,6 +19,18 @@ inline Size Radiation :: index (const Size p, const Size f ) const
 // }
 
 
+///  Getter for the slab of u and v in memory that holds ray r
+///  (when u and v are out of core, only one slab is kept in memory)
+///    @param[in] r : number of the ray
+///    @return index of the slab in u and v
+//////////////////////////////////////////////////////////////////
+accel inline Size Radiation :: resident_slab (const Size r) const
+{
+    if (out_of_core) {return 0;}
+    else             {return r;}
+}
+
+
 inline Real Radiation :: get_I_bdy (const Size R, const Size b, const Size f) const
 {
     return I_bdy[R][b][f];
@@ -1,41 +1,73 @@
 #include "scattering.hpp"
 
 
+const string prefix = "radiation/scattering";
+
+
 ///  read: read in data structure
+///  (without scattering data, the opacity is zero and scattering isotropic)
 ///    @param[in] io: io object
-/////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
 void Scattering :: read (const Io& io)
 {
-  cout << "Reading scattering..." << endl;
-
-//  nfreqs_scat = 1;
-//
-//
-//  // Size and initialize scattering opacity
-//	opacity_scat.resize (nfreqs_scat);
-//
-//	for (long f = 0; f < nfreqs_scat; f++)
-//	{
-//		opacity_scat[f] = 0.0;
-//	}
-//
-//
-//  // Size and initialize scattering phase function
-//
-//	phase.resize (nrays);
-//
-//	for (long r1 = 0; r1 < nrays; r1++)
-//	{
-//	  phase[r1].resize (nrays);
-//
-//		for (long r2 = 0; r2 < nrays; r2++)
-//		{
-//	    phase[r1][r2].resize (nfreqs_red);
-//
-//			for (long f = 0; f < nfreqs_red; f++)
-//			{
-//				phase[r1][r2][f] = 0.0;
-//			}
-//		}
-//	}
+    cout << "Reading scattering..." << endl;
+
+    opacity.resize (parameters.npoints());
+
+    if (io.read_list (prefix+"/opacity", opacity) != 0)
+    {
+        cout << "No scattering opacity, assuming zero." << endl;
+
+        // Do not rely on the reader to leave the buffer intact
+        opacity.resize (parameters.npoints());
+
+        for (Size p = 0; p < parameters.npoints(); p++) {opacity[p] = 0.0;}
+
+        opacity.copy_vec_to_ptr ();
+    }
+
+    io.read_number (prefix+".frequency_ref", frequency_ref);
+    io.read_number (prefix+".opacity_index", opacity_index);
+
+    if (io.read_list (prefix+"/moments", moments) != 0) {set_isotropic();}
+}
+
+
+///  write: write out data structure
+///    @param[in] io: io object
+/////////////////////////////////
+void Scattering :: write (const Io& io) const
+{
+    cout << "Writing scattering..." << endl;
+
+    io.write_list   (prefix+"/opacity",       opacity      );
+    io.write_number (prefix+".frequency_ref", frequency_ref);
+    io.write_number (prefix+".opacity_index", opacity_index);
+    io.write_list   (prefix+"/moments",       moments      );
+}
+
+
+///  Setter for an isotropic phase function
+///////////////////////////////////////////
+void Scattering :: set_isotropic ()
+{
+    moments.assign (1, 1.0);
+}
+
+
+///  Setter for a Henyey-Greenstein phase function, truncated at a given
+///  order of its Legendre expansion (the moments of which are g^l)
+///    @param[in] g     : asymmetry parameter (mean cosine of scattering angle)
+///    @param[in] order : highest order of the Legendre expansion
+/////////////////////////////////////////////////////////////////////////////
+void Scattering :: set_henyey_greenstein (const Real g, const Size order)
+{
+    moments.resize (order+1);
+
+    moments[0] = 1.0;
+
+    for (Size l = 1; l <= order; l++)
+    {
+        moments[l] = moments[l-1] * g;
+    }
 }
@@ -1,18 +1,34 @@
 #pragma once
 
 
+#include "io/io.hpp"
+#include "model/parameters/parameters.hpp"
 #include "tools/types.hpp"
 
 
+///  Scattering: (continuum) scattering opacity and phase function
+///  The phase function is given by a few Legendre moments and is evaluated
+///  on the fly, such that no (nrays x nrays x nfreqs) tables are needed.
+///////////////////////////////////////////////////////////////////////////
 struct Scattering
 {
-  	Real1 opacity_scat;   ///< scattering opacity (p,f)
-  	// Precalculate phase function for all frequencies
-  	Real3 phase;          ///< scattering phase function (r1,r2,f)
+    Parameters parameters;
+
+    Vector<Real> opacity;               ///< scattering opacity at the reference frequency (p)
+    Real         frequency_ref = 1.0;   ///< reference frequency of the opacity
+    Real         opacity_index = 0.0;   ///< opacity scales as (freq/frequency_ref)^opacity_index
+
+    Real1 moments = Real1 (1, 1.0);     ///< Legendre moments of the phase function (l), moments[0] = 1
 
     void read  (const Io& io);
     void write (const Io& io) const;
 
-    Size nfreqs_scat;   ///< number of frequencies in scattering data
-  	Size nfreqs_red;    ///< number of frequencies
+    void set_isotropic         ();
+    void set_henyey_greenstein (const Real g, const Size order);
+
+    accel inline Real get_opacity (const Size p, const Real freq) const;
+    accel inline Real phase       (const Real cos_angle)          const;
 };
+
+
+#include "scattering.tpp"
@@ -0,0 +1,36 @@
+///  Getter for the scattering opacity
+///    @param[in] p    : index of the point
+///    @param[in] freq : frequency (in co-moving frame)
+///    @return scattering opacity at point p and frequency freq
+////////////////////////////////////////////////////////////////
+accel inline Real Scattering :: get_opacity (const Size p, const Real freq) const
+{
+    if (opacity_index == 0.0) {return opacity[p];}
+
+    return opacity[p] * pow (freq / frequency_ref, opacity_index);
+}
+
+
+///  Evaluate the phase function from its Legendre moments, normalised such
+///  that its average over all directions is one (isotropic: phase = 1)
+///    @param[in] cos_angle : cosine of the scattering angle
+///    @return phase function for the scattering angle
+///////////////////////////////////////////////////////////////////////////
+accel inline Real Scattering :: phase (const Real cos_angle) const
+{
+    Real P_prev = 1.0;         // Legendre polynomial of order l-1
+    Real P_crt  = cos_angle;   // Legendre polynomial of order l
+    Real result = moments[0];
+
+    for (Size l = 1; l < moments.size(); l++)
+    {
+        result += (2*l+1) * moments[l] * P_crt;
+
+        const Real P_next = ((2*l+1) * cos_angle * P_crt - l * P_prev) / (l+1);
+
+        P_prev = P_crt;
+        P_crt  = P_next;
+    }
+
+    return result;
+}
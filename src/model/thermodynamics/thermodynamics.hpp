@@ -16,6 +16,17 @@ struct Thermodynamics
     void read  (const Io& io);
     void write (const Io& io) const;
 
+    ///  Set the parameters of the thermodynamics and its parts
+    ///    @param[in] params : parameters of the model
+    ///////////////////////////////////////////////////////////
+    inline void set_parameters (const Parameters& params)
+    {
+        parameters = params;
+
+        temperature.parameters = params;
+        turbulence .parameters = params;
+    }
+
     inline Real profile (
         const Real width,
         const Real freq_diff ) const;
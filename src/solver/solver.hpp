@@ -3,6 +3,7 @@
 
 #include "model/model.hpp"
 #include "tools/types.hpp"
+#include "tools/counters.hpp"
 
 
 class Solver
@@ -26,6 +27,10 @@ class Solver
         pc::multi_threading::ThreadPrivate<Size> last_;
         pc::multi_threading::ThreadPrivate<Size> n_tot_;
 
+        pc::multi_threading::ThreadPrivate<Size>  length_;     ///< current length of the ray buffers
+        pc::multi_threading::ThreadPrivate<Size>  centre_;     ///< index of the centre of the current ray pair
+        pc::multi_threading::ThreadPrivate<Size1> outliers_;   ///< points with ray pairs exceeding the cap
+
         pc::multi_threading::ThreadPrivate<Vector<Real>> Su_;
         pc::multi_threading::ThreadPrivate<Vector<Real>> Sv_;
 
@@ -44,6 +49,8 @@ class Solver
         pc::multi_threading::ThreadPrivate<Matrix<Real>> L_upper_;
         pc::multi_threading::ThreadPrivate<Matrix<Real>> L_lower_;
 
+        WorkCounters counters;   ///< work done by each thread (added to the model after each solve)
+
 
         // Kernel approach
         Vector<Real> eta;
@@ -60,11 +67,26 @@ class Solver
 
         template <Frame frame>
         void setup (Model& model);
+        template <Frame frame>
+        void setup (vector<Model>& models);
         void setup (const Size l, const Size w, const Size n_o_d);
 
+        inline Size get_bytes_per_ray_point () const;
+        inline void set_length_cap          (const double max_memory);
+        inline void resize_ray_buffers      (const Size i, const Size l);
+        inline void shrink_ray_buffers      ();
+        accel inline bool reserve_ray_buffers (
+            const Geometry& geometry,
+            const Size      rr,
+            const Size      o,
+            const bool      capped );
+
         accel inline Real get_dshift_max (
             const Model& model,
             const Size   o     );
+        accel inline Real get_dshift_max (
+            const vector<Model>& models,
+            const Size           o      );
 
         template <Frame frame>
         inline void get_ray_lengths     (Model& model);
@@ -73,16 +95,17 @@ class Solver
 
 
     // private:
-        Size length;
-        Size centre;
+        Size length_cap;   ///< maximum length of the ray buffers of a thread
         Size width;
 
         Size n_off_diag;
 
+        bool use_scattering = false;   ///< true if the scattered intensity is added to the source
+
 
         // void initialize (const Size l, const Size w);
 
-        template <Frame frame>
+        template <Frame frame, GeometryType geometry_type>
         accel inline Size trace_ray (
             const Geometry& geometry,
             const Size      o,
@@ -117,11 +140,20 @@ class Solver
             const Real   freq,
                   Real&  eta,
                   Real&  chi ) const;
+        accel inline void get_eta_and_chi (
+            const Model& model,
+            const Size   rr,
+            const Size   p,
+            const Size   f,
+            const Real   freq,
+                  Real&  eta,
+                  Real&  chi ) const;
 
         accel inline void update_Lambda (
                   Model &model,
             const Size   rr,
             const Size   f  );
+        inline void prune_Lambda (Model& model) const;
 
 
         accel inline void solve_shortchar_order_0 (Model& model);
@@ -132,14 +164,47 @@ class Solver
             const double dshift_max );
 
         accel inline void solve_feautrier_order_2 (Model& model);
+        accel inline void solve_feautrier_order_2 (vector<Model>& models);
+        template <GeometryType geometry_type>
+        accel inline void solve_feautrier_order_2 (Model& model);
+        template <GeometryType geometry_type>
+        accel inline void solve_feautrier_order_2 (vector<Model>& models);
+        template <GeometryType geometry_type>
         accel inline void solve_feautrier_order_2 (
                   Model& model,
             const Size   o,
             const Size   rr,
+            const Size   ar );
+        template <GeometryType geometry_type>
+        accel inline void solve_feautrier_order_2 (
+                  vector<Model>& models,
+            const Size           o,
+            const Size           rr,
+            const Size           ar );
+        accel inline void solve_feautrier_order_2 (
+                  Model& model,
+            const Size   o,
+            const Size   rr,
+            const Size   ar,
+            const Size   f  );
+
+        accel inline void solve_feautrier_order_2_diagonal (
+                  Model& model,
+            const Size   o,
+            const Size   rr,
             const Size   ar,
             const Size   f  );
 
         accel inline void image_feautrier_order_2 (Model& model, const Size rr);
+        template <GeometryType geometry_type>
+        accel inline void image_feautrier_order_2 (Model& model, const Size rr);
+        template <GeometryType geometry_type>
+        accel inline void image_feautrier_order_2 (
+                  Model& model,
+                  Image& image,
+            const Size   o,
+            const Size   rr,
+            const Size   ar );
         accel inline void image_feautrier_order_2 (
                   Model& model,
             const Size   o,
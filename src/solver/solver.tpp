@@ -1,56 +1,260 @@
+///  Setup the solver for a model, the ray buffers of each thread grow with
+///  the ray pairs it encounters, up to the memory cap in the parameters
+///    @param[in] model : model to solve for
+///////////////////////////////////////////////////////////////////////////
 template <Frame frame>
 inline void Solver :: setup (Model& model)
 {
-    const Size length = 2 * get_ray_lengths_max <frame> (model) + 1;
-    const Size  width = model.parameters.nfreqs();
-    const Size  n_o_d = model.parameters.n_off_diag;
+    {
+        Profiler::Stage stage (model.profiler, "ray_lengths");
+
+        get_ray_lengths_max <frame> (model);
+    }
+
+    const Size width = model.parameters.nfreqs();
+    const Size n_o_d = model.parameters.n_off_diag();
+
+    setup (0, width, n_o_d);
+
+    set_length_cap (model.parameters.max_solver_memory());
 
-    setup (length, width, n_o_d);
+    use_scattering = model.parameters.use_scattering() && (model.radiation.U.vec.size() > 0);
 }
 
 
+///  Setup the solver for an ensemble of model variants on the same geometry
+///  (rays are traced such that they are well sampled for all variants, the
+///  lengths are reused as long as they are valid for all variants)
+///    @param[in] models : model variants (sharing their geometry)
+/////////////////////////////////////////////////////////////////////////////
+template <Frame frame>
+inline void Solver :: setup (vector<Model>& models)
+{
+    Model&    model = models[0];
+    Geometry& geo   = model.geometry;
+
+    bool reuse = (frame == CoMoving)
+                 && (geo.lengths_for == &models)
+                 && (geo.lengths_lvl == geo.points.multiscale.curr_lvl);
+
+    for (Model& variant : models) {reuse = reuse && !variant.is_stale (Model::Q_RayLengths);}
+
+    if (!reuse)
+    {
+        Profiler::Stage stage (model.profiler, "ray_lengths");
+
+        for (Size rr = 0; rr < model.parameters.hnrays(); rr++)
+        {
+            const Size ar = geo.rays.antipod[rr];
+
+            accelerated_for (o, model.parameters.npoints(),
+            {
+                const Real dshift_max = get_dshift_max (models, o);
+
+                geo.lengths_first(rr,o) = geo.get_ray_length <frame> (o, rr, dshift_max);
+
+                geo.lengths(rr,o) =
+                    geo.lengths_first(rr,o)
+                  + geo.get_ray_length <frame> (o, ar, dshift_max);
+            })
+
+            pc::accelerator::synchronize();
+        }
+
+        geo.lengths      .copy_ptr_to_vec();
+        geo.lengths_first.copy_ptr_to_vec();
+
+        geo.lengths_max = *std::max_element(geo.lengths.vec.begin(),
+                                            geo.lengths.vec.end()   );
+        geo.lengths_lvl = geo.points.multiscale.curr_lvl;
+        geo.lengths_for = (frame == CoMoving) ? &models : 0;
+
+        for (Model& variant : models)
+        {
+            if (frame == CoMoving) {variant.dependencies.mark_computed (Model::Q_RayLengths);}
+            else                   {variant.dependencies.mark_stale    (Model::Q_RayLengths);}
+        }
+    }
+
+    const Size width = model.parameters.nfreqs();
+    const Size n_o_d = model.parameters.n_off_diag();
+
+    setup (0, width, n_o_d);
+
+    set_length_cap (model.parameters.max_solver_memory());
+
+    use_scattering = model.parameters.use_scattering() && (model.radiation.U.vec.size() > 0);
+}
+
+
+///  Setup the solver
+///    @param[in] l     : initial length of the ray buffers of each thread
+///    @param[in] w     : width of the frequency buffers
+///    @param[in] n_o_d : number of off-diagonals in the approximated Lambda operator
+///////////////////////////////////////////////////////////////////////////////////////
 inline void Solver :: setup (const Size l, const Size w, const Size n_o_d)
 {
-    length     = l;
-    centre     = l/2;
+    length_cap = std::numeric_limits<Size>::max();
     width      = w;
     n_off_diag = n_o_d;
 
     for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++)
     {
-        dZ_          (i).resize (length);
-        nr_          (i).resize (length);
-        shift_       (i).resize (length);
-
         eta_c_       (i).resize (width);
         eta_n_       (i).resize (width);
 
         chi_c_       (i).resize (width);
         chi_n_       (i).resize (width);
 
-        inverse_chi_ (i).resize (length);
-
         tau_         (i).resize (width);
 
-        Su_          (i).resize (length);
-        Sv_          (i).resize (length);
+        outliers_    (i).clear ();
+
+        resize_ray_buffers (i, l);
+    }
+}
+
+
+///  Getter for the memory taken by one point in the ray buffers of a thread
+///    @return number of bytes per point on a ray pair
+////////////////////////////////////////////////////////////////////////////
+inline Size Solver :: get_bytes_per_ray_point () const
+{
+    return 2*sizeof(double) + sizeof(Size) + (14 + 2*n_off_diag) * sizeof(Real);
+}
+
+
+///  Setter for the maximum length of the ray buffers of a thread
+///    @param[in] max_memory : memory available for the ray buffers of all threads (0: no cap)
+///////////////////////////////////////////////////////////////////////////////////////////////
+inline void Solver :: set_length_cap (const double max_memory)
+{
+    if (max_memory <= 0.0)
+    {
+        length_cap = std::numeric_limits<Size>::max();
+        return;
+    }
+
+    const double n_bytes = get_bytes_per_ray_point() * pc::multi_threading::n_threads_avail();
+
+    length_cap = std::min (max_memory / n_bytes, (double) std::numeric_limits<Size>::max());
+
+    cout << "Ray buffers capped at " << length_cap << " points per thread" << endl;
+}
+
 
-        A_           (i).resize (length);
-        C_           (i).resize (length);
-        inverse_A_   (i).resize (length);
-        inverse_C_   (i).resize (length);
+///  Reallocate the ray buffers of a thread (their contents are not kept)
+///    @param[in] i : thread index
+///    @param[in] l : new length of the ray buffers
+///////////////////////////////////////////////////////////////////////////
+inline void Solver :: resize_ray_buffers (const Size i, const Size l)
+{
+    length_(i) = l;
+
+    // Release the old memory first, such that shrinking actually frees memory
+    dZ_          (i).vec = std::vector<double>();
+    nr_          (i).vec = std::vector<Size  >();
+    shift_       (i).vec = std::vector<double>();
+    inverse_chi_ (i).vec = std::vector<Real  >();
+    Su_          (i).vec = std::vector<Real  >();
+    Sv_          (i).vec = std::vector<Real  >();
+    A_           (i).vec = std::vector<Real  >();
+    C_           (i).vec = std::vector<Real  >();
+    inverse_A_   (i).vec = std::vector<Real  >();
+    inverse_C_   (i).vec = std::vector<Real  >();
+    FF_          (i).vec = std::vector<Real  >();
+    FI_          (i).vec = std::vector<Real  >();
+    GG_          (i).vec = std::vector<Real  >();
+    GI_          (i).vec = std::vector<Real  >();
+    GP_          (i).vec = std::vector<Real  >();
+    L_diag_      (i).vec = std::vector<Real  >();
+    L_upper_     (i).vec = std::vector<Real  >();
+    L_lower_     (i).vec = std::vector<Real  >();
+
+    dZ_          (i).resize (l);
+    nr_          (i).resize (l);
+    shift_       (i).resize (l);
+
+    inverse_chi_ (i).resize (l);
+
+    Su_          (i).resize (l);
+    Sv_          (i).resize (l);
+
+    A_           (i).resize (l);
+    C_           (i).resize (l);
+    inverse_A_   (i).resize (l);
+    inverse_C_   (i).resize (l);
+
+    FF_          (i).resize (l);
+    FI_          (i).resize (l);
+    GG_          (i).resize (l);
+    GI_          (i).resize (l);
+    GP_          (i).resize (l);
+
+    L_diag_      (i).resize (l);
+
+    L_upper_     (i).resize (n_off_diag, l);
+    L_lower_     (i).resize (n_off_diag, l);
+}
+
+
+///  Shrink the ray buffers of all threads that grew beyond the cap (to hold
+///  outliers), such that the memory cap holds again for the next ray
+//////////////////////////////////////////////////////////////////////////////
+inline void Solver :: shrink_ray_buffers ()
+{
+    for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++)
+    {
+        if (length_(i) > length_cap) {resize_ray_buffers (i, length_cap);}
+    }
+}
 
-        FF_          (i).resize (length);
-        FI_          (i).resize (length);
-        GG_          (i).resize (length);
-        GI_          (i).resize (length);
-        GP_          (i).resize (length);
 
-        L_diag_      (i).resize (length);
+///  Make sure the ray buffers of the current thread can hold the ray pair
+///  through o along rr, and put the centre of the ray pair in the buffers.
+///  (The lengths of the ray pairs have to be computed in setup, they are
+///  only stored for the first half of the rays, the other half is looked
+///  up through the antipodal ray, with the two halves of the pair swapped.)
+///    @param[in] geometry : geometry of the model
+///    @param[in] rr       : number of the ray
+///    @param[in] o        : number of the point at the centre of the ray pair
+///    @param[in] capped   : if true, defer ray pairs that exceed the cap
+///    @return false if the ray pair was deferred as an outlier
+///////////////////////////////////////////////////////////////////////////////
+accel inline bool Solver :: reserve_ray_buffers (
+    const Geometry& geometry,
+    const Size      rr,
+    const Size      o,
+    const bool      capped )
+{
+    const Size rp = std::min (rr, geometry.rays.antipod[rr]);
 
-        L_upper_     (i).resize (n_off_diag, length);
-        L_lower_     (i).resize (n_off_diag, length);
+    // One spare element on either side of the ray pair
+    const Size n_required = geometry.lengths(rp,o) + 3;
+
+    if (n_required > length_())
+    {
+        if (capped && (n_required > length_cap))
+        {
+            outliers_().push_back (o);
+            return false;
+        }
+
+        // Grow geometrically, to avoid reallocating for every longer ray
+        Size new_length = std::max (n_required, length_() + length_()/2);
+
+        if (capped) {new_length = std::min (new_length, length_cap);}
+
+        resize_ray_buffers (pc::multi_threading::thread_id(), new_length);
     }
+
+    // Number of points on the first half of the ray pair (along rr)
+    const Size n_first = (rp == rr) ? geometry.lengths_first(rr,o)
+                                    : geometry.lengths(rp,o) - geometry.lengths_first(rp,o);
+
+    centre_() = n_first + 1;
+
+    return true;
 }
 
 
@@ -61,19 +265,26 @@ inline void Solver :: setup (const Size l, const Size w, const Size n_o_d)
 accel inline Real Solver :: get_dshift_max (
     const Model& model,
     const Size   o     )
+{
+    // The smallest relative line width is precomputed (in compute_inverse_line_widths)
+    return model.parameters.max_width_fraction() * model.lines.min_width[o];
+}
+
+
+///  Getter for the maximum allowed shift value over all model variants
+///    @param[in] models : model variants
+///    @param[in] o      : number of point under consideration
+///    @return smallest maximum allowed shift value of all variants
+////////////////////////////////////////////////////////////////////////
+accel inline Real Solver :: get_dshift_max (
+    const vector<Model>& models,
+    const Size           o      )
 {
     Real dshift_max = std::numeric_limits<Real>::max();
 
-    for (const LineProducingSpecies &lspec : model.lines.lineProducingSpecies)
+    for (const Model& model : models)
     {
-        const Real inverse_mass   = lspec.linedata.inverse_mass;
-        const Real new_dshift_max = model.parameters.max_width_fraction
-                                    * model.thermodynamics.profile_width (inverse_mass, o);
-
-        if (dshift_max > new_dshift_max)
-        {
-            dshift_max = new_dshift_max;
-        }
+        dshift_max = std::min (dshift_max, get_dshift_max (model, o));
     }
 
     return dshift_max;
@@ -91,27 +302,45 @@ inline void Solver :: get_ray_lengths (Model& model)
         {
             const Real dshift_max = get_dshift_max (model, o);
 
+            model.geometry.lengths_first(rr,o) = model.geometry.get_ray_length <frame> (o, rr, dshift_max);
+
             model.geometry.lengths(rr,o) =
-                model.geometry.get_ray_length <frame> (o, rr, dshift_max)
+                model.geometry.lengths_first(rr,o)
               + model.geometry.get_ray_length <frame> (o, ar, dshift_max);
         })
 
         pc::accelerator::synchronize();
     }
 
-    model.geometry.lengths.copy_ptr_to_vec();
+    model.geometry.lengths      .copy_ptr_to_vec();
+    model.geometry.lengths_first.copy_ptr_to_vec();
 }
 
 
 template <Frame frame>
 inline Size Solver :: get_ray_lengths_max (Model& model)
 {
-    get_ray_lengths <frame> (model);
-
     Geometry& geo = model.geometry;
 
+    // Reuse the (co-moving) ray lengths if nothing they depend on changed
+    // (and they were not computed for another model sharing the geometry)
+    if (   (frame == CoMoving)
+        && !model.is_stale (Model::Q_RayLengths)
+        && (geo.lengths_for == &model)
+        && (geo.lengths_lvl == geo.points.multiscale.curr_lvl) )
+    {
+        return geo.lengths_max;
+    }
+
+    get_ray_lengths <frame> (model);
+
     geo.lengths_max = *std::max_element(geo.lengths.vec.begin(),
                                         geo.lengths.vec.end()   );
+    geo.lengths_lvl = geo.points.multiscale.curr_lvl;
+    geo.lengths_for = (frame == CoMoving) ? &model : 0;
+
+    if (frame == CoMoving) {model.dependencies.mark_computed (Model::Q_RayLengths);}
+    else                   {model.dependencies.mark_stale    (Model::Q_RayLengths);}
 
     return geo.lengths_max;
 }
@@ -148,7 +377,9 @@ inline void Solver :: solve_shortchar_order_0 (Model& model)
 
     model.radiation.initialize_J();
 
-    for (Size rr = 0; rr < model.parameters.hnrays(); rr++)
+    // Every process solves for its share of the ray pairs
+    for (Size rr = pc::message_passing::start (model.parameters.hnrays());
+              rr < pc::message_passing::stop  (model.parameters.hnrays()); rr++)
     {
         const Size ar = model.geometry.rays.antipod[rr];
 
@@ -162,119 +393,418 @@ inline void Solver :: solve_shortchar_order_0 (Model& model)
             solve_shortchar_order_0 (model, o, rr, dshift_max);
             solve_shortchar_order_0 (model, o, ar, dshift_max);
 
-            for (Size f = 0; f < model.parameters.nfreqs(); f++)
+            const Size ru = model.radiation.resident_slab (rr);
+
+            for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
             {
-                model.radiation.u(rr,o,f) = 0.5 * (model.radiation.I(rr,o,f) + model.radiation.I(ar,o,f));
-                model.radiation.v(rr,o,f) = 0.5 * (model.radiation.I(rr,o,f) - model.radiation.I(ar,o,f));
+                model.radiation.u(ru,o,f) = 0.5 * (model.radiation.I(rr,o,f) + model.radiation.I(ar,o,f));
+                model.radiation.v(ru,o,f) = 0.5 * (model.radiation.I(rr,o,f) - model.radiation.I(ar,o,f));
             }
         })
 
         pc::accelerator::synchronize();
+
+        model.radiation.store_slab (rr);
     }
 
     model.radiation.I.copy_ptr_to_vec();
     model.radiation.J.copy_ptr_to_vec();
+
+    model.radiation.MPI_reduce_J();
+
+    counters.aggregate (model.counters);
 }
 
 
+///  Solve the Feautrier equation for all rays through all points
+///  (dispatches once on the geometry type, such that ray tracing is specialised)
+///    @param[in] model : model to solve for
+////////////////////////////////////////////////////////////////////////////////
+inline void Solver :: solve_feautrier_order_2 (Model& model)
+{
+    if (model.geometry.get_geometry_type() == SphericalSymmetry)
+    {
+        solve_feautrier_order_2 <SphericalSymmetry> (model);
+    }
+    else
+    {
+        solve_feautrier_order_2 <GeneralGeometry>   (model);
+    }
+}
+
+
+template <GeometryType geometry_type>
 inline void Solver :: solve_feautrier_order_2 (Model& model)
 {
     for (auto &lspec : model.lines.lineProducingSpecies) {lspec.lambda.clear();}
 
     model.radiation.initialize_J();
 
-    for (Size rr = 0; rr < model.parameters.hnrays(); rr++)
+    // Every process solves for its share of the ray pairs
+    for (Size rr = pc::message_passing::start (model.parameters.hnrays());
+              rr < pc::message_passing::stop  (model.parameters.hnrays()); rr++)
     {
         const Size ar = model.geometry.rays.antipod[rr];
 
         cout << "--- rr = " << rr << endl;
 
+        Profiler::Stage stage (model.profiler, "feautrier_direction", rr);
+
         accelerated_for (o, model.parameters.npoints(),
         {
-            const Real dshift_max = get_dshift_max (model, o);
-
-            nr_   ()[centre] = o;
-            shift_()[centre] = 1.0;
-
-            first_() = trace_ray <CoMoving> (model.geometry, o, rr, dshift_max, -1, centre-1, centre-1) + 1;
-            last_ () = trace_ray <CoMoving> (model.geometry, o, ar, dshift_max, +1, centre+1, centre  ) - 1;
-            n_tot_() = (last_()+1) - first_();
-
-            if (n_tot_() > 1)
+            if (reserve_ray_buffers (model.geometry, rr, o, true))
             {
-                for (Size f = 0; f < model.parameters.nfreqs(); f++)
-                {
-                    solve_feautrier_order_2 (model, o, rr, ar, f);
+                solve_feautrier_order_2 <geometry_type> (model, o, rr, ar);
+            }
+        })
 
-                    model.radiation.u(rr,o,f)  = Su_()[centre];
-                    model.radiation.J(   o,f) += Su_()[centre] * two * model.geometry.rays.weight[rr];
+        pc::accelerator::synchronize();
 
-                    update_Lambda (model, rr, f);
-                }
-            }
-            else
+        // Ray pairs exceeding the memory cap are solved one at a time
+        for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++)
+        {
+            for (const Size o : outliers_(i))
             {
-                for (Size f = 0; f < model.parameters.nfreqs(); f++)
-                {
-                    model.radiation.u(rr,o,f)  = boundary_intensity(model, o, model.radiation.frequencies.nu(o, f));
-                    model.radiation.J(   o,f) += two * model.geometry.rays.weight[rr] * model.radiation.u(rr,o,f);
-                }
+                reserve_ray_buffers (model.geometry, rr, o, false);
+                solve_feautrier_order_2 <geometry_type> (model, o, rr, ar);
             }
-        })
 
-        pc::accelerator::synchronize();
+            outliers_(i).clear();
+        }
+
+        shrink_ray_buffers ();
+
+        model.radiation.store_slab (rr, false);   // Feautrier only computes u
     }
 
     model.radiation.u.copy_ptr_to_vec();
     model.radiation.J.copy_ptr_to_vec();
+
+    {
+        Profiler::Stage stage (model.profiler, "mpi_reduction");
+
+        model.radiation.MPI_reduce_J();
+
+        for (auto &lspec : model.lines.lineProducingSpecies) {lspec.lambda.MPI_gather();}
+    }
+
+    prune_Lambda (model);
+
+    counters.aggregate (model.counters);
 }
 
 
-inline void Solver :: image_feautrier_order_2 (Model& model, const Size rr)
+///  Solve the Feautrier equation for a single ray pair, at all frequencies
+///  (the ray buffers have to be reserved with reserve_ray_buffers)
+///    @param[in] model : model to solve for
+///    @param[in] o     : number of the point at the centre of the ray pair
+///    @param[in] rr    : number of the ray
+///    @param[in] ar    : number of the antipodal ray
+////////////////////////////////////////////////////////////////////////////
+template <GeometryType geometry_type>
+accel inline void Solver :: solve_feautrier_order_2 (
+          Model& model,
+    const Size   o,
+    const Size   rr,
+    const Size   ar )
 {
-    Image image = Image(model.geometry, rr);
+    // Points that are not in the current (coarse) grid are skipped
+    if (!model.geometry.points.multiscale.in_grid (o)) {return;}
 
+    const Real dshift_max = get_dshift_max (model, o);
+    const Size centre     = centre_();
+    const Size ru         = model.radiation.resident_slab (rr);
 
-    cout << "--------------------------------------" << endl;
+    nr_   ()[centre] = o;
+    shift_()[centre] = 1.0;
 
-    const Size ar = model.geometry.rays.antipod[rr];
+    first_() = trace_ray <CoMoving, geometry_type> (model.geometry, o, rr, dshift_max, -1, centre-1, centre-1) + 1;
+    last_ () = trace_ray <CoMoving, geometry_type> (model.geometry, o, ar, dshift_max, +1, centre+1, centre  ) - 1;
+    n_tot_() = (last_()+1) - first_();
 
-    accelerated_for (o, model.parameters.npoints(),
+    counters.count_ray_length (n_tot_());
+
+    if (n_tot_() > 1)
     {
-        const Real dshift_max = get_dshift_max (model, o);
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
+        {
+            if (n_off_diag == 0) {solve_feautrier_order_2_diagonal (model, o, rr, ar, f);}
+            else                 {solve_feautrier_order_2          (model, o, rr, ar, f);}
 
-        nr_   ()[centre] = o;
-        shift_()[centre] = 1.0;
+            model.radiation.u(ru,o,f)  = Su_()[centre];
+            model.radiation.J(   o,f) += Su_()[centre] * two * model.geometry.rays.weight[rr];
+
+            update_Lambda (model, rr, f);
+        }
+    }
+    else
+    {
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
+        {
+            model.radiation.u(ru,o,f)  = boundary_intensity(model, o, model.radiation.frequencies.nu(o, f));
+            model.radiation.J(   o,f) += two * model.geometry.rays.weight[rr] * model.radiation.u(ru,o,f);
+        }
+    }
+}
 
-        first_() = trace_ray <Rest> (model.geometry, o, rr, dshift_max, -1, centre-1, centre-1) + 1;
-        last_ () = trace_ray <Rest> (model.geometry, o, ar, dshift_max, +1, centre+1, centre  ) - 1;
-        n_tot_() = (last_()+1) - first_();
 
-        if (n_tot_() > 1)
+///  Solve the Feautrier equation for an ensemble of model variants
+///  (dispatches once on the geometry type, such that ray tracing is specialised)
+///    @param[in] models : model variants (geometry taken from the first)
+////////////////////////////////////////////////////////////////////////////////
+inline void Solver :: solve_feautrier_order_2 (vector<Model>& models)
+{
+    if (models[0].geometry.get_geometry_type() == SphericalSymmetry)
+    {
+        solve_feautrier_order_2 <SphericalSymmetry> (models);
+    }
+    else
+    {
+        solve_feautrier_order_2 <GeneralGeometry>   (models);
+    }
+}
+
+
+///  Solve the Feautrier equation for an ensemble of model variants on the
+///  same geometry. Every ray is traced only once, after which it is solved
+///  for all variants back to back (while the ray data is still in cache).
+///    @param[in] models : model variants (geometry taken from the first)
+///////////////////////////////////////////////////////////////////////////
+template <GeometryType geometry_type>
+inline void Solver :: solve_feautrier_order_2 (vector<Model>& models)
+{
+    Model& model = models[0];
+
+    for (Model& variant : models)
+    {
+        for (auto &lspec : variant.lines.lineProducingSpecies) {lspec.lambda.clear();}
+
+        variant.radiation.initialize_J();
+    }
+
+    // Every process solves for its share of the ray pairs
+    for (Size rr = pc::message_passing::start (model.parameters.hnrays());
+              rr < pc::message_passing::stop  (model.parameters.hnrays()); rr++)
+    {
+        const Size ar = model.geometry.rays.antipod[rr];
+
+        cout << "--- rr = " << rr << endl;
+
+        Profiler::Stage stage (model.profiler, "feautrier_direction", rr);
+
+        accelerated_for (o, model.parameters.npoints(),
         {
-            for (Size f = 0; f < model.parameters.nfreqs(); f++)
+            if (reserve_ray_buffers (model.geometry, rr, o, true))
             {
-                image_feautrier_order_2 (model, o, rr, ar, f);
+                solve_feautrier_order_2 <geometry_type> (models, o, rr, ar);
+            }
+        })
+
+        pc::accelerator::synchronize();
 
-                image.I(o,f) = two*Su_()[first_()] - boundary_intensity(model, nr_()[first_()], model.radiation.frequencies.nu(o, f));
+        // Ray pairs exceeding the memory cap are solved one at a time
+        for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++)
+        {
+            for (const Size o : outliers_(i))
+            {
+                reserve_ray_buffers (model.geometry, rr, o, false);
+                solve_feautrier_order_2 <geometry_type> (models, o, rr, ar);
             }
+
+            outliers_(i).clear();
         }
-        else
+
+        shrink_ray_buffers ();
+
+        for (Model& variant : models) {variant.radiation.store_slab (rr, false);}
+    }
+
+    for (Model& variant : models)
+    {
+        variant.radiation.u.copy_ptr_to_vec();
+        variant.radiation.J.copy_ptr_to_vec();
+
+        variant.radiation.MPI_reduce_J();
+
+        for (auto &lspec : variant.lines.lineProducingSpecies) {lspec.lambda.MPI_gather();}
+
+        prune_Lambda (variant);
+    }
+
+    // The work for all variants is added to the first
+    counters.aggregate (model.counters);
+}
+
+
+///  Solve the Feautrier equation for a single ray pair, for all variants
+///  (the ray buffers have to be reserved with reserve_ray_buffers)
+///    @param[in] models : model variants (geometry taken from the first)
+///    @param[in] o      : number of the point at the centre of the ray pair
+///    @param[in] rr     : number of the ray
+///    @param[in] ar     : number of the antipodal ray
+/////////////////////////////////////////////////////////////////////////////
+template <GeometryType geometry_type>
+accel inline void Solver :: solve_feautrier_order_2 (
+          vector<Model>& models,
+    const Size           o,
+    const Size           rr,
+    const Size           ar )
+{
+    Model& model = models[0];
+
+    // Points that are not in the current (coarse) grid are skipped
+    if (!model.geometry.points.multiscale.in_grid (o)) {return;}
+
+    const Real dshift_max = get_dshift_max (models, o);
+    const Size centre     = centre_();
+
+    nr_   ()[centre] = o;
+    shift_()[centre] = 1.0;
+
+    first_() = trace_ray <CoMoving, geometry_type> (model.geometry, o, rr, dshift_max, -1, centre-1, centre-1) + 1;
+    last_ () = trace_ray <CoMoving, geometry_type> (model.geometry, o, ar, dshift_max, +1, centre+1, centre  ) - 1;
+    n_tot_() = (last_()+1) - first_();
+
+    counters.count_ray_length (n_tot_());
+
+    if (n_tot_() > 1)
+    {
+        for (Model& variant : models)
         {
-            for (Size f = 0; f < model.parameters.nfreqs(); f++)
+            const Size ru = variant.radiation.resident_slab (rr);
+
+            for (Size f = 0; f < variant.radiation.frequencies.nfreqs_red; f++)
+            {
+                if (n_off_diag == 0) {solve_feautrier_order_2_diagonal (variant, o, rr, ar, f);}
+                else                 {solve_feautrier_order_2          (variant, o, rr, ar, f);}
+
+                variant.radiation.u(ru,o,f)  = Su_()[centre];
+                variant.radiation.J(   o,f) += Su_()[centre] * two * model.geometry.rays.weight[rr];
+
+                update_Lambda (variant, rr, f);
+            }
+        }
+    }
+    else
+    {
+        for (Model& variant : models)
+        {
+            const Size ru = variant.radiation.resident_slab (rr);
+
+            for (Size f = 0; f < variant.radiation.frequencies.nfreqs_red; f++)
             {
-                image.I(o,f) = boundary_intensity(model, o, model.radiation.frequencies.nu(o, f));
+                variant.radiation.u(ru,o,f)  = boundary_intensity(variant, o, variant.radiation.frequencies.nu(o, f));
+                variant.radiation.J(   o,f) += two * model.geometry.rays.weight[rr] * variant.radiation.u(ru,o,f);
             }
         }
+    }
+}
+
+
+///  Compute an image along a ray direction
+///  (dispatches once on the geometry type, such that ray tracing is specialised)
+///    @param[in] model : model to image
+///    @param[in] rr    : number of the ray direction
+////////////////////////////////////////////////////////////////////////////////
+inline void Solver :: image_feautrier_order_2 (Model& model, const Size rr)
+{
+    if (model.geometry.get_geometry_type() == SphericalSymmetry)
+    {
+        image_feautrier_order_2 <SphericalSymmetry> (model, rr);
+    }
+    else
+    {
+        image_feautrier_order_2 <GeneralGeometry>   (model, rr);
+    }
+}
+
+
+template <GeometryType geometry_type>
+inline void Solver :: image_feautrier_order_2 (Model& model, const Size rr)
+{
+    Image image = Image(model.geometry, rr);
+
+
+    cout << "--------------------------------------" << endl;
+
+    const Size ar = model.geometry.rays.antipod[rr];
+
+    accelerated_for (o, model.parameters.npoints(),
+    {
+        if (reserve_ray_buffers (model.geometry, rr, o, true))
+        {
+            image_feautrier_order_2 <geometry_type> (model, image, o, rr, ar);
+        }
     })
 
     pc::accelerator::synchronize();
 
+    // Ray pairs exceeding the memory cap are solved one at a time
+    for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++)
+    {
+        for (const Size o : outliers_(i))
+        {
+            reserve_ray_buffers (model.geometry, rr, o, false);
+            image_feautrier_order_2 <geometry_type> (model, image, o, rr, ar);
+        }
+
+        outliers_(i).clear();
+    }
+
+    shrink_ray_buffers ();
+
     model.images.push_back (image);
 }
 
 
-template <Frame frame>
+///  Compute the image intensities of a single ray pair, at all frequencies
+///  (the ray buffers have to be reserved with reserve_ray_buffers)
+///    @param[in]  model : model to image
+///    @param[out] image : image in which the intensities are stored
+///    @param[in]  o     : number of the point at the centre of the ray pair
+///    @param[in]  rr    : number of the ray direction
+///    @param[in]  ar    : number of the antipodal ray
+////////////////////////////////////////////////////////////////////////////
+template <GeometryType geometry_type>
+accel inline void Solver :: image_feautrier_order_2 (
+          Model& model,
+          Image& image,
+    const Size   o,
+    const Size   rr,
+    const Size   ar )
+{
+    const Real dshift_max = get_dshift_max (model, o);
+    const Size centre     = centre_();
+
+    nr_   ()[centre] = o;
+    shift_()[centre] = 1.0;
+
+    first_() = trace_ray <Rest, geometry_type> (model.geometry, o, rr, dshift_max, -1, centre-1, centre-1) + 1;
+    last_ () = trace_ray <Rest, geometry_type> (model.geometry, o, ar, dshift_max, +1, centre+1, centre  ) - 1;
+    n_tot_() = (last_()+1) - first_();
+
+    counters.count_ray_length (n_tot_());
+
+    if (n_tot_() > 1)
+    {
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
+        {
+            image_feautrier_order_2 (model, o, rr, ar, f);
+
+            image.I(o,f) = two*Su_()[first_()] - boundary_intensity(model, nr_()[first_()], model.radiation.frequencies.nu(o, f));
+        }
+    }
+    else
+    {
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
+        {
+            image.I(o,f) = boundary_intensity(model, o, model.radiation.frequencies.nu(o, f));
+        }
+    }
+}
+
+
+template <Frame frame, GeometryType geometry_type>
 accel inline Size Solver :: trace_ray (
     const Geometry& geometry,
     const Size      o,
@@ -287,13 +817,13 @@ accel inline Size Solver :: trace_ray (
     double  Z = 0.0;   // distance from origin (o)
     double dZ = 0.0;   // last increment in Z
 
-    Size nxt = geometry.get_next (o, r, o, Z, dZ);
+    Size nxt = geometry.get_next <geometry_type> (o, r, o, Z, dZ);
 
     if (geometry.valid_point(nxt))
     {
         Size         crt = o;
-        double shift_crt = geometry.get_shift <frame> (o, r, crt, 0.0);
-        double shift_nxt = geometry.get_shift <frame> (o, r, nxt, Z  );
+        double shift_crt = geometry.get_shift <frame, geometry_type> (o, r, crt, 0.0);
+        double shift_nxt = geometry.get_shift <frame, geometry_type> (o, r, nxt, Z  );
 
         set_data (crt, nxt, shift_crt, shift_nxt, dZ, dshift_max, increment, id1, id2);
 
@@ -302,8 +832,8 @@ accel inline Size Solver :: trace_ray (
                   crt =       nxt;
             shift_crt = shift_nxt;
 
-                  nxt = geometry.get_next          (o, r, nxt, Z, dZ);
-            shift_nxt = geometry.get_shift <frame> (o, r, nxt, Z    );
+                  nxt = geometry.get_next  <geometry_type>        (o, r, nxt, Z, dZ);
+            shift_nxt = geometry.get_shift <frame, geometry_type> (o, r, nxt, Z    );
 
             set_data (crt, nxt, shift_crt, shift_nxt, dZ, dshift_max, increment, id1, id2);
         }
@@ -344,6 +874,8 @@ accel inline void Solver :: set_data (
             printf ("ERROR (n_intpl > 10 000) || (dshift_max < 0, probably due to overflow)\n");
         }
 
+        counters.count (WorkCounters::InterpolationPoints, n_interpl);
+
         // Assign current cell to first half of interpolation points
         for (Size m = 1; m < half_n_interpl; m++)
         {
@@ -440,6 +972,9 @@ accel inline void Solver :: get_eta_and_chi (
     eta = 0.0;
     chi = 1.0e-26;
 
+    counters.count (WorkCounters::EtaChiCalls);
+    counters.count (WorkCounters::LinesVisited, model.parameters.nlines());
+
     // Set line emissivity and opacity
     for (Size l = 0; l < model.parameters.nlines(); l++)
     {
@@ -467,6 +1002,37 @@ accel inline void Solver :: get_eta_and_chi (
 }
 
 
+///  Getter for the emissivity (eta) and the opacity (chi) along a ray pair,
+///  including scattering (if used), with the scattered intensity at bin f
+///    @param[in]  model : reference to model object
+///    @param[in]  rr    : number of the ray pair
+///    @param[in]  p     : index of the cell
+///    @param[in]  f     : index of the frequency bin
+///    @param[in]  freq  : frequency (in co-moving frame)
+///    @param[out] eta   : emissivity
+///    @param[out] chi   : opacity
+///////////////////////////////////////////////////////////////////////////
+accel inline void Solver :: get_eta_and_chi (
+    const Model& model,
+    const Size   rr,
+    const Size   p,
+    const Size   f,
+    const Real   freq,
+          Real&  eta,
+          Real&  chi ) const
+{
+    get_eta_and_chi (model, p, freq, eta, chi);
+
+    if (use_scattering)
+    {
+        const Real chi_scat = model.radiation.scattering.get_opacity (p, freq);
+
+        eta += chi_scat * model.radiation.U(rr, p, f);
+        chi += chi_scat;
+    }
+}
+
+
 ///  Apply trapezium rule to x_crt and x_nxt
 ///    @param[in] x_crt : current value of x
 ///    @param[in] x_nxt : next value of x
@@ -508,7 +1074,7 @@ accel inline void Solver :: solve_shortchar_order_0 (
         double shift_c = 1.0;
         double shift_n = model.geometry.get_shift <CoMoving> (o, r, nxt, Z);
 
-        for (Size f = 0; f < model.parameters.nfreqs(); f++)
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
         {
             const Real freq = model.radiation.frequencies.nu(o, f);
 
@@ -531,7 +1097,7 @@ accel inline void Solver :: solve_shortchar_order_0 (
 
             model.geometry.get_next (o, r, crt, nxt, Z, dZ, shift_n);
 
-            for (Size f = 0; f < model.parameters.nfreqs(); f++)
+            for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
             {
                 const Real freq = model.radiation.frequencies.nu(o, f);
 
@@ -545,7 +1111,7 @@ accel inline void Solver :: solve_shortchar_order_0 (
             }
         }
 
-        for (Size f = 0; f < model.parameters.nfreqs(); f++)
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
         {
             const Real freq = model.radiation.frequencies.nu(o, f);
 
@@ -556,7 +1122,7 @@ accel inline void Solver :: solve_shortchar_order_0 (
 
     else
     {
-        for (Size f = 0; f < model.parameters.nfreqs(); f++)
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
         {
             const Real freq = model.radiation.frequencies.nu(o, f);
 
@@ -569,14 +1135,15 @@ accel inline void Solver :: solve_shortchar_order_0 (
 
 accel inline void Solver :: update_Lambda (Model &model, const Size rr, const Size f)
 {
-    const Frequencies    &freqs     = model.radiation.frequencies;
-    const Thermodynamics &thermodyn = model.thermodynamics;
+    const Frequencies &freqs = model.radiation.frequencies;
+    const Lines       &lines = model.lines;
 
     if (freqs.appears_in_line_integral[f])
     {
-        const Size first = first_();
-        const Size last  = last_ ();
-        const Size n_tot = n_tot_();
+        const Size first  = first_ ();
+        const Size last   = last_  ();
+        const Size n_tot  = n_tot_ ();
+        const Size centre = centre_();
 
         Vector<Size  >& nr          = nr_         ();
         Vector<double>& shift       = shift_      ();
@@ -587,46 +1154,81 @@ accel inline void Solver :: update_Lambda (Model &model, const Size rr, const Si
 
         const Real w_ang = two * model.geometry.rays.weight[rr];
 
-        const Size l = freqs.corresponding_l_for_spec[f];   // index of species
-        const Size k = freqs.corresponding_k_for_tran[f];   // index of transition
-        const Size z = freqs.corresponding_z_for_line[f];   // index of quadrature point
+        // Loop over the line (l,k,z) components in this (possibly merged) bin
+        for (Size c = freqs.first_component[f]; c < freqs.first_component[f+1]; c++)
+        {
+            const Size l = freqs.corresponding_l_for_spec[c];   // index of species
+            const Size k = freqs.corresponding_k_for_tran[c];   // index of transition
+            const Size z = freqs.corresponding_z_for_line[c];   // index of quadrature point
+
+            LineProducingSpecies &lspec = model.lines.lineProducingSpecies[l];
 
-        LineProducingSpecies &lspec = model.lines.lineProducingSpecies[l];
+            const Size lid       = lines.line_index (l, k);
+            const Real freq_line = lspec.linedata.frequency[k];
+            const Real constante = lspec.linedata.A[k] * lspec.quadrature.weights[z] * w_ang;
 
-        const Real freq_line = lspec.linedata.frequency[k];
-        const Real invr_mass = lspec.linedata.inverse_mass;
-        const Real constante = lspec.linedata.A[k] * lspec.quadrature.weights[z] * w_ang;
+            Real frq = freqs.nu(nr[centre], f) * shift[centre];
+            Real phi = gaussian (lines.inverse_width(nr[centre], lid), frq - freq_line);
+            Real L   = constante * frq * phi * L_diag[centre] * inverse_chi[centre];
 
-        Real frq = freqs.nu(nr[centre], f) * shift[centre];
-        Real phi = thermodyn.profile(invr_mass, nr[centre], freq_line, frq);
-        Real L   = constante * frq * phi * L_diag[centre] * inverse_chi[centre];
+            lspec.lambda.add_element(nr[centre], k, nr[centre], L);
+            counters.count (WorkCounters::AloElements);
 
-        lspec.lambda.add_element(nr[centre], k, nr[centre], L);
+            // Off-diagonal elements below this are dropped
+            const Real L_min = model.parameters.alo_drop_tolerance() * fabs(L);
 
-        for (long m = 0; (m < n_off_diag) && (m+1 < n_tot); m++)
-        {
-            if (centre >= first+m+1) // centre-m-1 >= first
+            for (long m = 0; (m < n_off_diag) && (m+1 < n_tot); m++)
             {
-                const long n = centre-m-1;
-
-                frq = freqs.nu(nr[n], f) * shift[n];
-                phi = thermodyn.profile (invr_mass, nr[n], freq_line, frq);
-                L   = constante * frq * phi * L_lower(m,n) * inverse_chi[n];
+                if (centre >= first+m+1) // centre-m-1 >= first
+                {
+                    const long n = centre-m-1;
+
+                    frq = freqs.nu(nr[n], f) * shift[n];
+                    phi = gaussian (lines.inverse_width(nr[n], lid), frq - freq_line);
+                    L   = constante * frq * phi * L_lower(m,n) * inverse_chi[n];
+
+                    if (fabs(L) >= L_min)
+                    {
+                        lspec.lambda.add_element (nr[centre], k, nr[n], L);
+                        counters.count (WorkCounters::AloElements);
+                    }
+                    else {lspec.lambda.drop_element (nr[centre], k);}
+                }
 
-                lspec.lambda.add_element(nr[centre], k, nr[n], L);
+                if (centre+m+1 <= last) // centre+m+1 < last
+                {
+                    const long n = centre+m+1;
+
+                    frq = freqs.nu(nr[n], f) * shift[n];
+                    phi = gaussian (lines.inverse_width(nr[n], lid), frq - freq_line);
+                    L   = constante * frq * phi * L_upper(m,n) * inverse_chi[n];
+
+                    if (fabs(L) >= L_min)
+                    {
+                        lspec.lambda.add_element (nr[centre], k, nr[n], L);
+                        counters.count (WorkCounters::AloElements);
+                    }
+                    else {lspec.lambda.drop_element (nr[centre], k);}
+                }
             }
+        }
+    }
+}
 
-            if (centre+m+1 <= last) // centre+m+1 < last
-            {
-                const long n = centre+m+1;
 
-                frq = freqs.nu(nr[n], f) * shift[n];
-                phi = thermodyn.profile (invr_mass, nr[n], freq_line, frq);
-                L   = constante * frq * phi * L_upper(m,n) * inverse_chi[n];
+///  Cap the number of ALO elements per (p,k) and report how many were kept
+///    @param[in,out] model : model with the ALO of the last formal solution
+////////////////////////////////////////////////////////////////////////////
+inline void Solver :: prune_Lambda (Model& model) const
+{
+    if (n_off_diag == 0) {return;}
 
-                lspec.lambda.add_element(nr[centre], k, nr[n], L);
-            }
-        }
+    for (auto &lspec : model.lines.lineProducingSpecies)
+    {
+        lspec.lambda.prune (model.parameters.alo_max_elements());
+
+        cout << "ALO: " << lspec.lambda.get_n_kept   () << " elements kept, "
+                        << lspec.lambda.get_n_dropped() << " dropped" << endl;
     }
 }
 
@@ -647,9 +1249,10 @@ accel inline void Solver :: solve_feautrier_order_2 (
     Real eta_c, chi_c, dtau_c, term_c;
     Real eta_n, chi_n, dtau_n, term_n;
 
-    const Size first = first_();
-    const Size last  = last_ ();
-    const Size n_tot = n_tot_();
+    const Size first  = first_ ();
+    const Size last   = last_  ();
+    const Size centre = centre_();
+    const Size n_tot  = n_tot_ ();
 
     Vector<double>& dZ    = dZ_   ();
     Vector<Size  >& nr    = nr_   ();
@@ -677,8 +1280,8 @@ accel inline void Solver :: solve_feautrier_order_2 (
 
 
     // Get optical properties for first two elements
-    get_eta_and_chi (model, nr[first  ], freq*shift[first  ], eta_c, chi_c);
-    get_eta_and_chi (model, nr[first+1], freq*shift[first+1], eta_n, chi_n);
+    get_eta_and_chi (model, rr, nr[first  ], f, freq*shift[first  ], eta_c, chi_c);
+    get_eta_and_chi (model, rr, nr[first+1], f, freq*shift[first+1], eta_n, chi_n);
 
     inverse_chi[first  ] = 1.0 / chi_c;
     inverse_chi[first+1] = 1.0 / chi_n;
@@ -714,7 +1317,7 @@ accel inline void Solver :: solve_feautrier_order_2 (
          chi_c =  chi_n;
 
         // Get new radiative properties
-        get_eta_and_chi (model, nr[n+1], freq*shift[n+1], eta_n, chi_n);
+        get_eta_and_chi (model, rr, nr[n+1], f, freq*shift[n+1], eta_n, chi_n);
 
         inverse_chi[n+1] = 1.0 / chi_n;
 
@@ -817,6 +1420,145 @@ accel inline void Solver :: solve_feautrier_order_2 (
 }
 
 
+///  Solver for Feautrier equation along ray pairs using the (ordinary)
+///  2nd-order solver, specialised for a diagonal approximated Lambda
+///  operator (n_off_diag == 0). Only Su[centre] and L_diag[centre] are
+///  required, so only the recurrences leading to those are kept, with the
+///  intermediate quantities in registers where possible.
+///    @param[in] model : model to solve for
+///    @param[in] o     : number of the point at the centre of the ray pair
+///    @param[in] rr    : number of the ray
+///    @param[in] ar    : number of the antipodal ray
+///    @param[in] f     : frequency index
+///////////////////////////////////////////////////////////////////////////
+accel inline void Solver :: solve_feautrier_order_2_diagonal (
+          Model& model,
+    const Size   o,
+    const Size   rr,
+    const Size   ar,
+    const Size   f  )
+{
+    const Real freq = model.radiation.frequencies.nu(o, f);
+
+    Real eta_c, chi_c, dtau_c, term_c;
+    Real eta_n, chi_n, dtau_n, term_n;
+
+    const Size first  = first_ ();
+    const Size last   = last_  ();
+    const Size centre = centre_();
+
+    Vector<double>& dZ    = dZ_   ();
+    Vector<Size  >& nr    = nr_   ();
+    Vector<double>& shift = shift_();
+
+    Vector<Real>& inverse_chi = inverse_chi_();
+
+    Vector<Real>& Su        = Su_       ();
+    Vector<Real>& FI        = FI_       ();
+    Vector<Real>& inverse_A = inverse_A_();
+    Vector<Real>& inverse_C = inverse_C_();
+
+    Vector<Real>& L_diag = L_diag_();
+
+
+    // Get optical properties for first two elements
+    get_eta_and_chi (model, rr, nr[first  ], f, freq*shift[first  ], eta_c, chi_c);
+    get_eta_and_chi (model, rr, nr[first+1], f, freq*shift[first+1], eta_n, chi_n);
+
+    inverse_chi[first  ] = 1.0 / chi_c;
+    inverse_chi[first+1] = 1.0 / chi_n;
+
+    term_c = eta_c * inverse_chi[first  ];
+    term_n = eta_n * inverse_chi[first+1];
+    dtau_n = half * (chi_c + chi_n) * dZ[first];
+
+    // Set boundary conditions
+    const Real inverse_dtau_f = one / dtau_n;
+    const Real C_first        = two * inverse_dtau_f * inverse_dtau_f;
+
+    inverse_C[first] = 1.0 / C_first;   // Required for Lambda_diag
+
+    const Real Bf_min_Cf = one + two * inverse_dtau_f;
+    const Real Bf        = Bf_min_Cf + C_first;
+    const Real I_bdy_f   = boundary_intensity (model, nr[first], freq*shift[first]);
+
+    Su[first]  = term_c + two * I_bdy_f * inverse_dtau_f;
+    Su[first] /= Bf;
+
+    /// Write economically: F[first] = (B[first] - C[first]) / C[first];
+    Real FF        = half * Bf_min_Cf * dtau_n * dtau_n;
+    Real FF_centre = FF;
+
+    FI[first] = one / (one + FF);
+
+
+    /// Set body of Feautrier matrix
+    for (Size n = first+1; n < last; n++)
+    {
+        term_c = term_n;
+        dtau_c = dtau_n;
+         chi_c =  chi_n;
+
+        // Get new radiative properties
+        get_eta_and_chi (model, rr, nr[n+1], f, freq*shift[n+1], eta_n, chi_n);
+
+        inverse_chi[n+1] = 1.0 / chi_n;
+
+        term_n = eta_n * inverse_chi[n+1];
+        dtau_n = half * (chi_c + chi_n) * dZ[n];
+
+        const Real dtau_avg = half * (dtau_c + dtau_n);
+        inverse_A[n] = dtau_avg * dtau_c;
+        inverse_C[n] = dtau_avg * dtau_n;
+
+        const Real A = one / inverse_A[n];
+
+        FF    = (A * FF * FI[n-1] + one) * inverse_C[n];
+        FI[n] = one / (one + FF);
+        Su[n] = (A * Su[n-1] + term_c) * FI[n] * inverse_C[n];
+
+        if (n == centre) {FF_centre = FF;}
+    }
+
+
+    /// Set boundary conditions (FF is now F[last-1])
+    const Real inverse_dtau_l = one / dtau_n;
+    const Real A_last         = two * inverse_dtau_l * inverse_dtau_l;
+
+    const Real Bl_min_Al = one + two * inverse_dtau_l;
+    const Real Bl        = Bl_min_Al + A_last;
+
+    const Real denominator = one / (Bl * FF + Bl_min_Al);
+
+    const Real I_bdy_l = boundary_intensity (model, nr[last], freq*shift[last]);
+
+    Su[last] = term_n + two * I_bdy_l * inverse_dtau_l;
+    Su[last] = (A_last * Su[last-1] + Su[last]) * (one + FF) * denominator;
+
+    if (centre < last)
+    {
+        /// Write economically: G[last] = (B[last] - A[last]) / A[last];
+        Real GG = half * Bl_min_Al * dtau_n * dtau_n;
+        Real GP = GG / (one + GG);
+
+        for (long n = last-1; n > centre; n--) // use long in reverse loops!
+        {
+            Su[n] += Su[n+1] * FI[n];
+
+            GG = (GP / inverse_C[n] + one) * inverse_A[n];
+            GP = GG / (one + GG);
+        }
+
+        Su    [centre] += Su[centre+1] * FI[centre];
+        L_diag[centre]  = inverse_C[centre] / (FF_centre + GP);
+    }
+    else
+    {
+        L_diag[centre] = (one + FF) / (Bl_min_Al + Bl*FF);
+    }
+}
+
+
 ///  Solver for Feautrier equation along ray pairs using the (ordinary)
 ///  2nd-order solver, without adaptive optical depth increments
 ///    @param[in] w : width index
@@ -1159,7 +1901,7 @@ accel inline void Solver :: set_eta_and_chi (Model& model) const
 
     for (Size p = 0; p < model.parameters.npoints(); p++)
     {
-        for (Size f = 0; f < model.parameters.nfreqs(); f++)
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
         {
             const Real freq = model.radiation.frequencies.nu(0, f);
 
@@ -1177,7 +1919,7 @@ accel inline void Solver :: set_boundary_condition (Model& model) const
     {
         const Size p = model.geometry.boundary.boundary2point[b];
 
-        for (Size f = 0; f < model.parameters.nfreqs(); f++)
+        for (Size f = 0; f < model.radiation.frequencies.nfreqs_red; f++)
         {
             const Real freq = model.radiation.frequencies.nu(0, f);
 
@@ -0,0 +1,145 @@
+#pragma once
+
+
+#include <map>
+#include <algorithm>
+
+#include "../configure.hpp"
+#include "tools/types.hpp"
+
+
+///  WorkCounters: counts the work done in the hot paths of the solver, to
+///  tell why an iteration is slow. Every thread counts in its own slot; the
+///  slots are summed (over threads and processes) with aggregate, at the end
+///  of each solve. Counting is only compiled in with WORK_COUNTERS (and not
+///  on the GPU), otherwise the counts remain zero and cost nothing.
+/////////////////////////////////////////////////////////////////////////////
+struct WorkCounters
+{
+    enum Counter {EtaChiCalls, LinesVisited, InterpolationPoints, ShortRays,
+                  AloElements, RateNonZeros, n_counters};
+
+    enum {n_bins = 32};   ///< number of bins of the ray length histogram
+
+    Size_t1 totals    = Size_t1 (n_counters, 0);   ///< aggregated counts
+    Size_t1 histogram = Size_t1 (n_bins,     0);   ///< aggregated ray lengths (bin b holds [2^b, 2^(b+1)))
+
+
+#if (WORK_COUNTERS) && !(GPU_ACCELERATION)
+
+    ///  Add to a counter of the calling thread
+    ///    @param[in] counter : counter to add to
+    ///    @param[in] n       : amount to add
+    ///////////////////////////////////////////////
+    accel inline void count (const Counter counter, const size_t n = 1) const
+    {
+        slots_().counts[counter] += n;
+    }
+
+    ///  Add the length of a ray (pair) to the histogram of the calling thread,
+    ///  rays with at most one point are also counted as ShortRays
+    ///    @param[in] n_tot : number of points on the ray (pair)
+    ////////////////////////////////////////////////////////////////////////////
+    accel inline void count_ray_length (const Size n_tot) const
+    {
+        Size bin = 0;
+
+        while ((bin+1 < n_bins) && (n_tot >> (bin+1))) {bin++;}
+
+        slots_().lengths[bin]++;
+
+        if (n_tot <= 1) {slots_().counts[ShortRays]++;}
+    }
+
+    ///  Sum the counts of all threads (and processes), add them to the totals
+    ///  of the given counters, and reset the counts of the threads
+    ///    @param[in,out] target : counters to add the totals to
+    ///////////////////////////////////////////////////////////////////////////
+    inline void aggregate (WorkCounters& target) const
+    {
+        Size_t1 sum (n_counters + n_bins, 0);
+
+        for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++)
+        {
+            for (Size c = 0; c < n_counters; c++) {sum[c         ] += slots_(i).counts [c];}
+            for (Size b = 0; b < n_bins;     b++) {sum[n_counters+b] += slots_(i).lengths[b];}
+
+            slots_(i) = Slot ();
+        }
+
+#       if (MPI_PARALLEL)
+            int ierr = MPI_Allreduce (
+                          MPI_IN_PLACE,        // pointer to data to be reduced -> here in place
+                          sum.data(),          // pointer to data to be received
+                          sum.size(),          // size of data to be received
+                          MPI_UNSIGNED_LONG,   // type of reduced data
+                          MPI_SUM,             // reduction operation
+                          MPI_COMM_WORLD);
+            assert (ierr == 0);
+#       endif
+
+        for (Size c = 0; c < n_counters; c++) {target.totals   [c] += sum[c         ];}
+        for (Size b = 0; b < n_bins;     b++) {target.histogram[b] += sum[n_counters+b];}
+    }
+
+#else
+
+    // Counting is not compiled in, the counts remain zero
+    accel inline void count            (const Counter, const size_t = 1) const {}
+    accel inline void count_ray_length (const Size                     ) const {}
+          inline void aggregate        (WorkCounters&                  ) const {}
+
+#endif
+
+    ///  Reset all counts
+    /////////////////////
+    inline void clear ()
+    {
+        std::fill (totals   .begin(), totals   .end(), 0);
+        std::fill (histogram.begin(), histogram.end(), 0);
+
+        for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++) {slots_(i) = Slot ();}
+    }
+
+    ///  Getter for the name of a counter
+    ///    @param[in] counter : counter to name
+    /////////////////////////////////////////
+    static inline string get_name (const Counter counter)
+    {
+        switch (counter)
+        {
+            case EtaChiCalls         : return "eta_and_chi_calls";
+            case LinesVisited        : return "lines_visited";
+            case InterpolationPoints : return "interpolation_points";
+            case ShortRays           : return "short_rays";
+            case AloElements         : return "alo_elements";
+            case RateNonZeros        : return "rate_matrix_nonzeros";
+            default                  : return "unknown";
+        }
+    }
+
+    ///  Getter for the aggregated counts by name
+    /////////////////////////////////////////////
+    inline std::map<string, size_t> get_totals () const
+    {
+        std::map<string, size_t> named;
+
+        for (Size c = 0; c < n_counters; c++) {named[get_name ((Counter) c)] = totals[c];}
+
+        return named;
+    }
+
+    inline Size_t1 get_histogram () const {return histogram;}
+
+
+    private:
+
+        struct Slot
+        {
+            size_t counts  [n_counters] = {};   ///< counts of a thread
+            size_t lengths [n_bins]     = {};   ///< ray length histogram of a thread
+        };
+
+        // Counting does not change the state that is being counted
+        mutable pc::multi_threading::ThreadPrivate<Slot> slots_;
+};
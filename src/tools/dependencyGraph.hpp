@@ -0,0 +1,104 @@
+#pragma once
+
+
+#include "tools/types.hpp"
+
+
+///  DependencyGraph: keeps track of which (derived) quantities are stale
+///  Every node is a quantity, and each derived quantity depends on a set
+///  of other quantities. When a quantity changes, all quantities that
+///  (directly or indirectly) depend on it are marked stale, such that
+///  only those have to be recomputed.
+/////////////////////////////////////////////////////////////////////////
+class DependencyGraph
+{
+    private:
+        vector<Size1> dependents;   ///< direct dependents of each quantity
+        vector<bool>  stale;        ///< true if the quantity needs recomputing
+
+    public:
+        DependencyGraph (const Size n_quantities)
+            : dependents (n_quantities)
+            , stale      (n_quantities, true) {};
+
+        ///  Declare that a quantity depends on another
+        ///    @param[in] quantity : dependent quantity
+        ///    @param[in] input    : quantity it depends on
+        //////////////////////////////////////////////////
+        inline void add_dependency (const Size quantity, const Size input)
+        {
+            dependents[input].push_back (quantity);
+        }
+
+        ///  Mark a quantity as changed, making all its dependents stale
+        ///  (also those behind a dependent that was already stale, since
+        ///  that one might be recomputed before the others)
+        ///    @param[in] quantity : quantity that changed
+        ////////////////////////////////////////////////////////////////////
+        inline void mark_changed (const Size quantity)
+        {
+            for (const Size dependent : dependents[quantity])
+            {
+                stale[dependent] = true;
+                mark_changed (dependent);
+            }
+        }
+
+        ///  Mark a quantity as (re)computed from its current inputs. Its
+        ///  dependents remain valid, since recomputing from the same inputs
+        ///  yields the same result (otherwise use mark_changed as well).
+        ///    @param[in] quantity : quantity that was recomputed
+        /////////////////////////////////////////////////////////////////////
+        inline void mark_computed (const Size quantity)
+        {
+            stale[quantity] = false;
+        }
+
+        ///  Mark a quantity (and hence also its dependents) stale
+        ///    @param[in] quantity : quantity that is no longer valid
+        ////////////////////////////////////////////////////////////
+        inline void mark_stale (const Size quantity)
+        {
+            stale[quantity] = true;
+            mark_changed (quantity);
+        }
+
+        ///  Mark all quantities stale (e.g. after reading a new model)
+        ///////////////////////////////////////////////////////////////
+        inline void mark_all_stale ()
+        {
+            stale.assign (stale.size(), true);
+        }
+
+        ///  Check whether a quantity needs to be recomputed
+        ///    @param[in] quantity : quantity to check
+        ///    @return true if the quantity is stale
+        ////////////////////////////////////////////////////
+        inline bool is_stale (const Size quantity) const
+        {
+            return stale[quantity];
+        }
+};
+
+
+///  Fingerprint: hash (FNV-1a) of the values of a quantity, to detect changes
+///  that were made directly in the data, rather than through a setter
+//////////////////////////////////////////////////////////////////////////////
+struct Fingerprint
+{
+    size_t hash = 14695981039346656037ULL;   ///< current hash
+
+    ///  Add a value to the fingerprint
+    ///    @param[in] value : value to add
+    ///////////////////////////////////////
+    inline void add (const double value)
+    {
+        const unsigned char* bytes = (const unsigned char*) &value;
+
+        for (Size b = 0; b < sizeof(double); b++)
+        {
+            hash ^= bytes[b];
+            hash *= 1099511628211ULL;
+        }
+    }
+};
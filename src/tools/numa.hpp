@@ -0,0 +1,209 @@
+#pragma once
+
+
+#include "tools/types.hpp"
+
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+
+///  NUMA placement of large arrays
+///  Memory pages are placed on the NUMA node of the thread that first
+///  touches them. Arrays that are allocated (and zeroed) by the master
+///  thread therefore all end up on one node. The functions below re-place
+///  arrays indexed as [outer][point][inner] such that every page is first
+///  touched by the thread that handles the corresponding points in
+///  threaded_for, and report where the pages ended up.
+///  (Only effective on Linux, elsewhere the functions do nothing.)
+///////////////////////////////////////////////////////////////////////////
+
+
+///  Getter for the NUMA node of the calling thread
+///    @return NUMA node number (0 if unknown)
+//////////////////////////////////////////////////
+inline int numa_current_node ()
+{
+#ifdef __linux__
+    unsigned cpu  = 0;
+    unsigned node = 0;
+
+    if (syscall (SYS_getcpu, &cpu, &node, nullptr) == 0) {return node;}
+#endif
+    return 0;
+}
+
+
+///  Getter for the NUMA node of the page holding an address
+///    @param[in] address : address to look up
+///    @return NUMA node number (negative if the page is not resident)
+//////////////////////////////////////////////////////////////////////
+inline int numa_node_of (const void* address)
+{
+#ifdef __linux__
+    void* page   = const_cast<void*> (address);
+    int   status = -1;
+
+    if (syscall (SYS_move_pages, 0, 1, &page, nullptr, &status, 0) == 0) {return status;}
+#endif
+    return -1;
+}
+
+
+///  Pin every thread to its own CPU (in the order of the affinity mask of
+///  the process), such that threads keep using the memory they touched.
+///////////////////////////////////////////////////////////////////////////
+inline void numa_pin_threads ()
+{
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO (&mask);
+
+    if (sched_getaffinity (0, sizeof(mask), &mask) != 0) {return;}
+
+    vector<int> cpus;
+
+    for (int c = 0; c < CPU_SETSIZE; c++)
+    {
+        if (CPU_ISSET (c, &mask)) {cpus.push_back (c);}
+    }
+
+    if (cpus.empty()) {return;}
+
+    // Every thread gets exactly one iteration
+    threaded_for (t, pc::multi_threading::n_threads_avail(),
+    {
+        cpu_set_t cpu;
+        CPU_ZERO (&cpu);
+        CPU_SET  (cpus[t % cpus.size()], &cpu);
+
+        sched_setaffinity (0, sizeof(cpu), &cpu);
+    })
+
+    cout << "Pinned " << pc::multi_threading::n_threads_avail() << " threads to "
+         << cpus.size() << " cpus" << endl;
+#endif
+}
+
+
+///  Release the (whole) pages within a memory range, such that they are
+///  placed again on the first touch (they read as zero until written).
+///    @param[in] data  : start of the memory range
+///    @param[in] bytes : size of the memory range
+/////////////////////////////////////////////////////////////////////////
+inline void numa_release_pages (void* data, const size_t bytes)
+{
+#ifdef __linux__
+    const uintptr_t page_size = sysconf (_SC_PAGESIZE);
+    const uintptr_t begin     = ((uintptr_t) data + page_size - 1) / page_size * page_size;
+    const uintptr_t end       = ((uintptr_t) data + bytes        ) / page_size * page_size;
+
+    if (end > begin) {madvise ((void*) begin, end - begin, MADV_DONTNEED);}
+#endif
+}
+
+
+///  Re-place an array [n_outer][n_points][n_inner] such that its pages are
+///  first touched with the same partitioning over the points as threaded_for.
+///  The contents are kept. Only for ordinary (heap) memory, not file-backed.
+///    @param[in,out] data     : array to re-place
+///    @param[in]     n_outer  : number of slabs
+///    @param[in]     n_points : number of points in a slab
+///    @param[in]     n_inner  : number of elements per point
+///////////////////////////////////////////////////////////////////////////////
+template <typename type>
+inline void numa_first_touch (
+          type* data,
+    const Size  n_outer,
+    const Size  n_points,
+    const Size  n_inner )
+{
+    const size_t slab_size = (size_t) n_points * n_inner;
+
+    // Go slab by slab, such that only one slab needs to be copied at a time
+    for (Size i = 0; i < n_outer; i++)
+    {
+        type* slab = data + i*slab_size;
+
+        const vector<type> copy (slab, slab + slab_size);
+
+        numa_release_pages (slab, slab_size*sizeof(type));
+
+        threaded_for (p, n_points,
+        {
+            for (Size k = 0; k < n_inner; k++)
+            {
+                slab[p*n_inner+k] = copy[p*n_inner+k];
+            }
+        })
+    }
+}
+
+
+///  Print the NUMA placement of an array [n_outer][n_points][n_inner], i.e.
+///  the fraction of its pages that are local to the threads handling them
+///    @param[in] name     : name of the array in the report
+///    @param[in] data     : array to report on
+///    @param[in] n_outer  : number of slabs
+///    @param[in] n_points : number of points in a slab
+///    @param[in] n_inner  : number of elements per point
+////////////////////////////////////////////////////////////////////////////
+template <typename type>
+inline void numa_report (
+    const string name,
+    const type*  data,
+    const Size   n_outer,
+    const Size   n_points,
+    const Size   n_inner )
+{
+    const uintptr_t page_size = sysconf (_SC_PAGESIZE);
+    const size_t    row_bytes = n_inner * sizeof(type);
+
+    vector<size_t> n_local  (pc::multi_threading::n_threads_avail(), 0);
+    vector<size_t> n_remote (pc::multi_threading::n_threads_avail(), 0);
+    vector<size_t> n_absent (pc::multi_threading::n_threads_avail(), 0);
+
+    for (Size i = 0; i < n_outer; i++)
+    {
+        const type* slab = data + (size_t) i*n_points*n_inner;
+
+        threaded_for (p, n_points,
+        {
+            const Size      t     = pc::multi_threading::thread_id();
+            const int       node  = numa_current_node();
+            const uintptr_t begin = (uintptr_t) (slab + p*n_inner);
+            const uintptr_t end   = begin + row_bytes;
+
+            // A page is counted for the row that starts in it (or for the first row in it)
+            uintptr_t page = begin / page_size;
+            if ((p > 0) && ((begin-1) / page_size == page)) {page++;}
+
+            for (; page*page_size < end; page++)
+            {
+                const int page_node = numa_node_of ((void*) (page*page_size));
+
+                if      (page_node <  0   ) {n_absent[t]++;}
+                else if (page_node == node) {n_local [t]++;}
+                else                        {n_remote[t]++;}
+            }
+        })
+    }
+
+    size_t local = 0, remote = 0, absent = 0;
+
+    for (Size t = 0; t < pc::multi_threading::n_threads_avail(); t++)
+    {
+        local  += n_local [t];
+        remote += n_remote[t];
+        absent += n_absent[t];
+    }
+
+    const size_t total = local + remote + absent;
+
+    cout << name << ": " << total << " pages, "
+         << 100.0 * local / std::max (total, (size_t) 1) << "% local, "
+         << remote << " remote, " << absent << " not resident" << endl;
+}
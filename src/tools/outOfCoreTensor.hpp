@@ -0,0 +1,98 @@
+#pragma once
+
+
+#include <fstream>
+#include <stdexcept>
+
+#include "tools/types.hpp"
+
+
+///  OutOfCoreTensor: tensor (nslabs, nrows, ncols) that is kept in a binary
+///  file rather than in memory, and that is written and read one slab (of
+///  nrows x ncols elements) at a time. Only the file name is stored, the file
+///  is opened for every slab, such that the object can be copied freely.
+///////////////////////////////////////////////////////////////////////////////
+template <typename type>
+struct OutOfCoreTensor
+{
+    string file_name;    ///< name of the file holding the tensor
+    Size   nslabs = 0;   ///< number of slabs
+    Size   nrows  = 0;   ///< number of rows in a slab
+    Size   ncols  = 0;   ///< number of columns in a slab
+
+    ///  Create (or overwrite) the file for a tensor of the given size
+    ///    @param[in] name : name of the file
+    ///    @param[in] ns   : number of slabs
+    ///    @param[in] nr   : number of rows in a slab
+    ///    @param[in] nc   : number of columns in a slab
+    ///////////////////////////////////////////////////////////////////
+    inline void create (const string name, const Size ns, const Size nr, const Size nc)
+    {
+        file_name = name;
+        nslabs    = ns;
+        nrows     = nr;
+        ncols     = nc;
+
+        std::ofstream file (file_name, std::ios::binary | std::ios::trunc);
+
+        if (!file) {throw std::runtime_error ("Cannot create out-of-core file " + file_name);}
+
+        // Allocate the whole file by writing its last byte
+        if (nslabs*slab_bytes() > 0)
+        {
+            file.seekp (nslabs*slab_bytes() - 1);
+            file.put   (0);
+        }
+    }
+
+    ///  Use an existing file (created with create, e.g. by another process),
+    ///  without touching its contents
+    ///    @param[in] name : name of the file
+    ///    @param[in] ns   : number of slabs
+    ///    @param[in] nr   : number of rows in a slab
+    ///    @param[in] nc   : number of columns in a slab
+    ///////////////////////////////////////////////////////////////////////////
+    inline void attach (const string name, const Size ns, const Size nr, const Size nc)
+    {
+        file_name = name;
+        nslabs    = ns;
+        nrows     = nr;
+        ncols     = nc;
+    }
+
+    ///  Getter for the size of a slab in the file
+    ///    @return number of bytes in a slab
+    ///////////////////////////////////////////////
+    inline std::streamoff slab_bytes () const
+    {
+        return (std::streamoff) nrows * ncols * sizeof(type);
+    }
+
+    ///  Write a slab to the file
+    ///    @param[in] s    : index of the slab
+    ///    @param[in] slab : data of the slab (nrows x ncols, row-major)
+    ////////////////////////////////////////////////////////////////////
+    inline void write_slab (const Size s, const type* slab) const
+    {
+        std::fstream file (file_name, std::ios::binary | std::ios::in | std::ios::out);
+
+        file.seekp (s*slab_bytes());
+        file.write ((const char*) slab, slab_bytes());
+
+        if (!file) {throw std::runtime_error ("Cannot write slab to out-of-core file " + file_name);}
+    }
+
+    ///  Read a slab from the file
+    ///    @param[in]  s    : index of the slab
+    ///    @param[out] slab : data of the slab (nrows x ncols, row-major)
+    /////////////////////////////////////////////////////////////////////
+    inline void read_slab (const Size s, type* slab) const
+    {
+        std::ifstream file (file_name, std::ios::binary);
+
+        file.seekg (s*slab_bytes());
+        file.read  ((char*) slab, slab_bytes());
+
+        if (!file) {throw std::runtime_error ("Cannot read slab from out-of-core file " + file_name);}
+    }
+};
@@ -57,6 +57,14 @@ class SetOnce
         }
 
 
+        ///  Getter for a reference to the value (bypasses the set once check)
+        ///////////////////////////////////////////////////////////////////////
+        accel inline type& ref ()
+        {
+            return value;
+        }
+
+
         accel inline type get () const
         {
             return value;
@@ -5,12 +5,16 @@
 using std::cout;
 using std::endl;
 #include <fstream>
+#include <sstream>
+#include <iomanip>
 #include <string>
 using std::string;
 #include <vector>
 using std::vector;
 #include <chrono>
 
+#include "tools/types.hpp"
+
 
 /// TIMER: class for precise process timing
 ///////////////////////////////////////////
@@ -136,6 +140,206 @@ class Timer
 
 
 
+///  Profiler: collects the time spent in (named) stages of a computation,
+///  per iteration, and reports them in a machine-readable format (JSON/CSV).
+///  Every record is identified by an iteration, a stage and an index (e.g.
+///  the ray direction or the species, -1 if the stage is not indexed).
+///////////////////////////////////////////////////////////////////////////////
+class Profiler
+{
+    public:
+
+        struct Record
+        {
+            size_t iteration;   ///< iteration in which the stage was timed
+            string stage;       ///< name of the stage
+            long   index;       ///< index within the stage (-1 if none)
+            size_t calls;       ///< number of times the stage was timed
+            double seconds;     ///< total time spent in the stage
+        };
+
+        ///  Stage: times a stage from its construction until its destruction
+        //////////////////////////////////////////////////////////////////////
+        class Stage
+        {
+            private:
+
+                Profiler&   profiler;
+                string      stage;
+                long        index;
+                singleTimer timer;
+
+            public:
+
+                Stage (Profiler& p, const string s, const long i = -1)
+                    : profiler (p)
+                    , stage    (s)
+                    , index    (i) {timer.start();};
+
+                ~Stage ()
+                {
+                    timer.stop();
+                    profiler.add (stage, index, timer.get_interval());
+                }
+        };
+
+
+    private:
+
+        size_t         iteration = 0;   ///< current iteration
+        vector<Record> records;         ///< records of the finished iterations (in order of first use)
+
+        // Every thread collects the records of the current iteration in its own list
+        pc::multi_threading::ThreadPrivate<vector<Record>> current_;
+
+        ///  Add a record to a list, or accumulate it in the matching record
+        ///    @param[in,out] list   : list of records
+        ///    @param[in]     first  : first record of the iteration in the list
+        ///    @param[in]     record : record to add
+        //////////////////////////////////////////////////////////////////////////
+        static inline void accumulate (vector<Record>& list, const size_t first, const Record& record)
+        {
+            size_t r = first;
+
+            while ((r < list.size()) && ((list[r].stage != record.stage) || (list[r].index != record.index))) {r++;}
+
+            if (r == list.size())
+            {
+                list.push_back ({record.iteration, record.stage, record.index, 0, 0.0});
+            }
+
+            list[r].calls   += record.calls;
+            list[r].seconds += record.seconds;
+        }
+
+        ///  Merge the records of the current iteration of all threads into a list
+        ///    @param[in,out] list : list of records to merge into
+        ///////////////////////////////////////////////////////////////////////////
+        inline void merge_current (vector<Record>& list) const
+        {
+            const size_t first = list.size();
+
+            for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++)
+            {
+                for (const Record& record : current_(i)) {accumulate (list, first, record);}
+            }
+        }
+
+
+    public:
+
+        ///  Start a new iteration (records are kept per iteration), the
+        ///  records of the threads are merged into those of the previous one
+        ///  (not to be called from within a threaded loop)
+        //////////////////////////////////////////////////////////////////////
+        inline void start_iteration ()
+        {
+            merge_current (records);
+
+            for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++) {current_(i).clear();}
+
+            iteration++;
+        }
+
+        ///  Add time spent in a stage to the current iteration of the calling thread
+        ///    @param[in] stage   : name of the stage
+        ///    @param[in] index   : index within the stage (-1 if none)
+        ///    @param[in] seconds : time spent in the stage
+        /////////////////////////////////////////////////////////////////////////////
+        inline void add (const string stage, const long index, const double seconds)
+        {
+            vector<Record>& list = current_();
+
+            accumulate (list, 0, {iteration, stage, index, 1, seconds});
+        }
+
+        ///  Remove all records and restart the iteration count
+        ////////////////////////////////////////////////////////
+        inline void clear ()
+        {
+            iteration = 0;
+
+            records.clear();
+
+            for (Size i = 0; i < pc::multi_threading::n_threads_avail(); i++) {current_(i).clear();}
+        }
+
+        ///  Getter for all records, including those of the current iteration
+        ///////////////////////////////////////////////////////////////////////
+        inline vector<Record> get_records () const
+        {
+            vector<Record> list = records;
+
+            merge_current (list);
+
+            return list;
+        }
+
+        ///  Getter for the report in JSON format (a list of records)
+        /////////////////////////////////////////////////////////////
+        inline string get_json () const
+        {
+            std::ostringstream json;
+            json << std::setprecision (9) << "[";
+
+            const vector<Record> list = get_records();
+
+            for (size_t r = 0; r < list.size(); r++)
+            {
+                json << ((r == 0) ? "\n" : ",\n")
+                     << "  {\"iteration\": " << list[r].iteration
+                     << ", \"stage\": \""   << list[r].stage
+                     << "\", \"index\": "   << list[r].index
+                     << ", \"calls\": "     << list[r].calls
+                     << ", \"seconds\": "   << list[r].seconds << "}";
+            }
+
+            json << "\n]\n";
+
+            return json.str();
+        }
+
+        ///  Getter for the report in CSV format (one line per record)
+        //////////////////////////////////////////////////////////////
+        inline string get_csv () const
+        {
+            std::ostringstream csv;
+            csv << std::setprecision (9) << "iteration,stage,index,calls,seconds" << "\n";
+
+            for (const Record& record : get_records())
+            {
+                csv << record.iteration << ","
+                    << record.stage     << ","
+                    << record.index     << ","
+                    << record.calls     << ","
+                    << record.seconds   << "\n";
+            }
+
+            return csv.str();
+        }
+
+        ///  Write the report to a file in JSON format
+        ///    @param[in] file_name : name of the file
+        //////////////////////////////////////////////
+        inline void write_json (const string file_name) const
+        {
+            std::ofstream file (file_name);
+            file << get_json();
+        }
+
+        ///  Write the report to a file in CSV format
+        ///    @param[in] file_name : name of the file
+        //////////////////////////////////////////////
+        inline void write_csv (const string file_name) const
+        {
+            std::ofstream file (file_name);
+            file << get_csv();
+        }
+};
+
+
+
+
 #if (MAGRITTE_MPI_PARALLEL)
 
 /// MPI_TIMER: class for precise process timing when using MPI
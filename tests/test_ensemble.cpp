@@ -0,0 +1,58 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include "model/model.hpp"
+#include "ensemble/ensemble.hpp"
+
+
+///  Test for the Ensemble: an ensemble of a single variant should give the
+///  same radiation field as solving the model itself, without copying the
+///  geometry of the model
+///////////////////////////////////////////////////////////////////////////
+int main (int argc, char **argv)
+{
+    const string modelName = argv[1];
+
+    cout << "Running test_ensemble..."                               << endl;
+    cout << "------------------------"                               << endl;
+    cout << "Model name: " << modelName                              << endl;
+    cout << "n threads = " << pc::multi_threading::n_threads_avail() << endl;
+
+    Model model (modelName);
+    model.compute_spectral_discretisation ();
+    model.compute_LTE_level_populations   ();
+    model.compute_inverse_line_widths     ();
+
+    model.compute_radiation_field_feautrier_order_2 ();
+
+    Ensemble ensemble (model, 1);
+    ensemble.compute_radiation_field_feautrier_order_2 ();
+
+    const Model& variant = ensemble.variant (0);
+
+    int n_errors = 0;
+
+    if (variant.shared_geometry != model.shared_geometry) {n_errors++;}
+
+    Real max_diff = 0.0;
+
+    for (Size p = 0; p < model.parameters.npoints(); p++)
+    {
+        for (Size f = 0; f < model.parameters.nfreqs(); f++)
+        {
+            const Real J_model   = model  .radiation.J(p,f);
+            const Real J_variant = variant.radiation.J(p,f);
+
+            max_diff = std::max (max_diff, fabs (J_variant - J_model) / (fabs (J_model) + 1.0e-30));
+        }
+    }
+
+    if (max_diff > 1.0e-12) {n_errors++;}
+
+    cout << "max relative difference in J = " << max_diff << endl;
+    cout << "n errors = "                     << n_errors << endl;
+    cout << "Done."                                       << endl;
+
+    return (n_errors > 0);
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include "gtest/gtest.h"
+#include "io/cpp/io_cpp_text.hpp"
+
+
+// All files are written in the working directory, with this prefix
+const IoText io ("test_io_text_");
+
+
+TEST (io_text, round_trip_reals)
+{
+    const Real1 list = {0.0, -1.5, 1.0/3.0, 6.62607015e-34, 2.99792458e+10, -1.0e+300};
+
+    ASSERT_EQ (io.write_list ("reals", list), 0);
+
+    Real1 result;
+
+    ASSERT_EQ (io.read_list ("reals", result), 0);
+    ASSERT_EQ (result.size(), list.size());
+    EXPECT_EQ (io.get_length ("reals"), list.size());
+
+    // Values are written with 17 significant digits
+    for (Size i = 0; i < list.size(); i++)
+    {
+        EXPECT_LE (fabsl (result[i] - list[i]), 1.0e-16 * fabsl (list[i]));
+    }
+
+    Real number;
+
+    ASSERT_EQ (io.write_number ("real", list[2]), 0);
+    ASSERT_EQ (io.read_number  ("real", number ), 0);
+
+    EXPECT_LE (fabsl (number - list[2]), 1.0e-16 * list[2]);
+}
+
+
+TEST (io_text, round_trip_integers)
+{
+    const Size1   sizes  = {0, 1, 42, 4294967295u};
+    const Size_t1 sizes_ = {0, 7, 18446744073709551615ul};
+    const Long1   longs  = {-9223372036854775807l, -1, 0, 123456789012l};
+
+    ASSERT_EQ (io.write_list ("sizes",  sizes ), 0);
+    ASSERT_EQ (io.write_list ("sizes_", sizes_), 0);
+    ASSERT_EQ (io.write_list ("longs",  longs ), 0);
+
+    Size1   sizes_read;
+    Size_t1 sizes__read;
+    Long1   longs_read;
+
+    ASSERT_EQ (io.read_list ("sizes",  sizes_read ), 0);
+    ASSERT_EQ (io.read_list ("sizes_", sizes__read), 0);
+    ASSERT_EQ (io.read_list ("longs",  longs_read ), 0);
+
+    EXPECT_EQ (sizes_read,  sizes );
+    EXPECT_EQ (sizes__read, sizes_);
+    EXPECT_EQ (longs_read,  longs );
+
+    Size number;
+
+    ASSERT_EQ (io.write_number ("size", sizes[3]), 0);
+    ASSERT_EQ (io.read_number  ("size", number  ), 0);
+
+    EXPECT_EQ (number, sizes[3]);
+}
+
+
+TEST (io_text, round_trip_strings)
+{
+    const String1 list = {"H2", "CO", "p-H2", "e-"};
+
+    ASSERT_EQ (io.write_list ("strings", list), 0);
+
+    String1 result;
+
+    ASSERT_EQ (io.read_list ("strings", result), 0);
+
+    EXPECT_EQ (result, list);
+
+    string word;
+
+    ASSERT_EQ (io.write_word ("word", list[2]), 0);
+    ASSERT_EQ (io.read_word  ("word", word   ), 0);
+
+    EXPECT_EQ (word, list[2]);
+}
+
+
+TEST (io_text, empty_file)
+{
+    ASSERT_EQ (io.write_list ("empty", Real1 ()), 0);
+
+    // An empty file holds an empty list, whatever was in the list before
+    Real1 result = {1.0, 2.0};
+
+    EXPECT_EQ (io.read_list  ("empty", result), 0);
+    EXPECT_EQ (result.size(), 0);
+    EXPECT_EQ (io.get_length ("empty"), 0);
+
+    // A missing file is an error, and leaves the list untouched
+    Real1 missing = {1.0, 2.0};
+
+    EXPECT_EQ (io.read_list ("missing", missing), -1);
+    EXPECT_EQ (missing.size(), 2);
+}
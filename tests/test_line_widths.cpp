@@ -0,0 +1,132 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include "model/model.hpp"
+#include "tools/timer.hpp"
+
+
+///  Microbenchmark for the precomputed line width tables, comparing the
+///  maximum allowed shift (dshift_max) and line profile evaluations from
+///  the temperature (as before) with those from the tables in Lines.
+///////////////////////////////////////////////////////////////////////////
+int main (int argc, char **argv)
+{
+    const string modelName = argv[1];
+    const Size   nrepeats  = (argc > 2) ? std::stoul (argv[2]) : 100;
+
+    cout << "Running test_line_widths..."                            << endl;
+    cout << "---------------------------"                            << endl;
+    cout << "Model name: " << modelName                              << endl;
+    cout << "n threads = " << pc::multi_threading::n_threads_avail() << endl;
+
+    Model model (modelName);
+    model.compute_inverse_line_widths ();
+
+    const Parameters     &parameters = model.parameters;
+    const Thermodynamics &thermodyn  = model.thermodynamics;
+    const Lines          &lines      = model.lines;
+
+    Real sum_ref = 0.0;
+    Real sum_tab = 0.0;
+
+
+    // dshift_max from the temperature (for every species)
+    Timer timer_dshift_ref ("dshift_max from temperature");
+    timer_dshift_ref.start();
+    for (Size i = 0; i < nrepeats; i++)
+    {
+        for (Size o = 0; o < parameters.npoints(); o++)
+        {
+            Real dshift_max = std::numeric_limits<Real>::max();
+
+            for (const LineProducingSpecies &lspec : lines.lineProducingSpecies)
+            {
+                const Real inverse_mass   = lspec.linedata.inverse_mass;
+                const Real new_dshift_max = parameters.max_width_fraction()
+                                            * thermodyn.profile_width (inverse_mass, o);
+
+                if (dshift_max > new_dshift_max) {dshift_max = new_dshift_max;}
+            }
+
+            sum_ref += dshift_max;
+        }
+    }
+    timer_dshift_ref.stop();
+    timer_dshift_ref.print();
+
+    // dshift_max from the table
+    Timer timer_dshift_tab ("dshift_max from table");
+    timer_dshift_tab.start();
+    for (Size i = 0; i < nrepeats; i++)
+    {
+        for (Size o = 0; o < parameters.npoints(); o++)
+        {
+            sum_tab += parameters.max_width_fraction() * lines.min_width[o];
+        }
+    }
+    timer_dshift_tab.stop();
+    timer_dshift_tab.print();
+
+    cout << "relative difference = " << fabs (sum_tab - sum_ref) / sum_ref << endl;
+
+
+    sum_ref = 0.0;
+    sum_tab = 0.0;
+
+    // Line profiles from the temperature
+    Timer timer_profile_ref ("profile from temperature");
+    timer_profile_ref.start();
+    for (Size i = 0; i < nrepeats; i++)
+    {
+        for (Size p = 0; p < parameters.npoints(); p++)
+        {
+            for (Size l = 0; l < parameters.nlspecs(); l++)
+            {
+                const LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+                for (Size k = 0; k < lspec.linedata.nrad; k++)
+                {
+                    const Real freq_line = lspec.linedata.frequency[k];
+                    const Real freq      = freq_line * (1.0 + 1.0e-5);
+
+                    sum_ref += thermodyn.profile (lspec.linedata.inverse_mass, p, freq_line, freq);
+                }
+            }
+        }
+    }
+    timer_profile_ref.stop();
+    timer_profile_ref.print();
+
+    // Line profiles from the inverse widths
+    Timer timer_profile_tab ("profile from inverse widths");
+    timer_profile_tab.start();
+    for (Size i = 0; i < nrepeats; i++)
+    {
+        for (Size p = 0; p < parameters.npoints(); p++)
+        {
+            for (Size l = 0; l < parameters.nlspecs(); l++)
+            {
+                const LineProducingSpecies &lspec = lines.lineProducingSpecies[l];
+
+                for (Size k = 0; k < lspec.linedata.nrad; k++)
+                {
+                    const Real freq_line = lspec.linedata.frequency[k];
+                    const Real freq      = freq_line * (1.0 + 1.0e-5);
+                    const Real inv_width = lines.inverse_width (p, lines.line_index (l, k));
+                    const Real sqrt_exp  = inv_width * (freq - freq_line);
+
+                    sum_tab += inv_width * INVERSE_SQRT_PI * exp (-sqrt_exp*sqrt_exp);
+                }
+            }
+        }
+    }
+    timer_profile_tab.stop();
+    timer_profile_tab.print();
+
+    cout << "relative difference = " << fabs (sum_tab - sum_ref) / sum_ref << endl;
+
+    cout << "Done." << endl;
+
+    return (0);
+}
@@ -0,0 +1,173 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include "model/model.hpp"
+
+
+///  Test for the MPI mode, in which every process solves for a share of the
+///  rays and for the level populations of a share of the points, checking
+///  the reductions and exchanges between the processes (mpirun -np 4)
+///////////////////////////////////////////////////////////////////////////////
+int main (int argc, char **argv)
+{
+#if (MPI_PARALLEL)
+
+    MPI_Init (&argc, &argv);
+
+    const Size rank  = pc::message_passing::comm_rank();
+    const Size nproc = pc::message_passing::comm_size();
+
+    if (rank == 0)
+    {
+        cout << "Running test_mpi..."                                    << endl;
+        cout << "-------------------"                                    << endl;
+        cout << "n processes = " << nproc                                << endl;
+        cout << "n threads   = " << pc::multi_threading::n_threads_avail() << endl;
+    }
+
+    const Size npoints = 10;
+    const Size nfreqs  = 3;
+    const Size nrad    = 2;
+
+    Model model;
+    model.parameters.set_npoints (npoints);
+    model.parameters.set_nfreqs  (nfreqs );
+
+    int n_errors = 0;
+
+
+    // Every process adds its own contribution to J
+    model.radiation.parameters = model.parameters;
+    model.radiation.J.resize (npoints, nfreqs);
+
+    for (Size p = 0; p < npoints; p++)
+    {
+        for (Size f = 0; f < nfreqs; f++)
+        {
+            model.radiation.J(p,f) = rank + 1;
+        }
+    }
+
+    model.radiation.MPI_reduce_J ();
+
+    for (Size p = 0; p < npoints; p++)
+    {
+        for (Size f = 0; f < nfreqs; f++)
+        {
+            if (model.radiation.J(p,f) != 0.5*nproc*(nproc+1)) {n_errors++;}
+        }
+    }
+
+
+    // Every process adds a diagonal element and one that only it has
+    Lambda lambda;
+    lambda.parameters = model.parameters;
+    lambda.initialize (nrad);
+
+    for (Size p = 0; p < npoints; p++)
+    {
+        for (Size k = 0; k < nrad; k++)
+        {
+            lambda.add_element  (p, k, p,                 rank + 1);
+            lambda.add_element  (p, k, (p+rank+1)%npoints, 1.0    );
+            lambda.drop_element (p, k);
+        }
+    }
+
+    lambda.MPI_gather ();
+
+    for (Size p = 0; p < npoints; p++)
+    {
+        for (Size k = 0; k < nrad; k++)
+        {
+            Real sum = 0.0;
+
+            for (Size m = 0; m < lambda.get_size (p,k); m++)
+            {
+                sum += lambda.get_Ls (p,k,m);
+            }
+
+            if (sum != 0.5*nproc*(nproc+1) + nproc) {n_errors++;}
+        }
+    }
+
+    if (lambda.get_n_dropped() != npoints*nrad*nproc) {n_errors++;}
+
+
+    // Every process solves the rate equations of a two-level species for
+    // its own points only, the populations are gathered afterwards
+    LineProducingSpecies lspec;
+    lspec.parameters        = model.parameters;
+    lspec.linedata.nlev     = 2;
+    lspec.linedata.nrad     = 1;
+    lspec.linedata.ncol_tot = 0;
+    lspec.linedata.irad     = {1};
+    lspec.linedata.jrad     = {0};
+    lspec.linedata.A        = {1.0e-3};
+    lspec.linedata.Ba       = {2.0e-3};
+    lspec.linedata.Bs       = {1.0e-3};
+
+    lspec.lambda.parameters = model.parameters;
+    lspec.lambda.initialize (1);
+
+    lspec.population     = VectorXr::Constant (2*npoints, 0.5);
+    lspec.population_tot = Real1 (npoints, 1.0);
+    lspec.Jeff           = Real2 (npoints, Real1 (1, 0.0));
+
+    Real1 ratio (npoints);
+
+    for (Size p = 0; p < npoints; p++)
+    {
+        lspec.Jeff[p][0] = p + 1.0;
+        lspec.lambda.add_element (p, 0, p, 1.0e-2);
+
+        const Real v_alo = -1.0e-2 * lspec.get_opacity (p, 0);
+
+        ratio[p] = lspec.linedata.Ba[0] * lspec.Jeff[p][0]
+                   / (lspec.linedata.A[0] + lspec.linedata.Bs[0] * lspec.Jeff[p][0] + v_alo);
+    }
+
+    lspec.solve_statistical_equilibrium (Double2 (npoints, Double1 (1, 1.0)), Vector<Real> (Real1 (npoints, 1.0)));
+
+    for (Size p = 0; p < npoints; p++)
+    {
+        const Real n_u = ratio[p] / (1.0 + ratio[p]);
+
+        if (fabs (lspec.population(lspec.index (p,1)) - n_u) > 1.0e-12) {n_errors++;}
+    }
+
+
+#if (WORK_COUNTERS)
+    // Every process counts some work, which is summed over the processes
+    WorkCounters counters;
+
+    counters.count            (WorkCounters::EtaChiCalls, rank + 1);
+    counters.count_ray_length (5);
+    counters.aggregate        (model.counters);
+
+    if (model.counters.totals[WorkCounters::EtaChiCalls] != 0.5*nproc*(nproc+1)) {n_errors++;}
+    if (model.counters.histogram[2]                      != nproc              ) {n_errors++;}
+#endif
+
+
+    MPI_Allreduce (MPI_IN_PLACE, &n_errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    if (rank == 0)
+    {
+        cout << "n errors = " << n_errors << endl;
+        cout << "Done."                   << endl;
+    }
+
+    MPI_Finalize ();
+
+    return (n_errors > 0);
+
+#else
+
+    cout << "test_mpi requires MPI_PARALLEL." << endl;
+
+    return (0);
+
+#endif
+}
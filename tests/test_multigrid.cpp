@@ -2,73 +2,41 @@
 using std::cout;
 using std::endl;
 
-#include "io/python/io_python.hpp"
 #include "model/model.hpp"
-#include "solver/solver.hpp"
-
-
-//__global__
-//void kernel ()
-//{
-//    return;
-//}
-
-//inline void test (Geometry &geometry)
-//{
-//    geometry.points.position.vec[0].print();
-//    geometry.points.position.vec[1].print();
-//
-//    Geometry* geometry_copy = (Geometry*) pc::accelerator::malloc(sizeof(Geometry));
-//    pc::accelerator::memcpy_to_accelerator (geometry_copy, &geometry, sizeof(Geometry));
-//    kernel<<<1,1>>> (geometry_copy);
-//
-//    points.position.vec[0].print();
-//    points.position.copy_ptr_to_vec ();
-//    points.position.vec[0].print();
-//}
+#include "tools/timer.hpp"
 
 
 int main (int argc, char **argv)
 {
-    cout << "Running test_multigrid..." << endl;
-
-    /// Store model name
     const string modelName = argv[1];
-
-    cout << modelName << endl;
-
-    pc::accelerator::list_accelerators();
-
-    IoPython io ("hdf5", modelName);
-
-
-    cout << "sizeof Model    = " << sizeof(Model)    << endl;
-    cout << "sizeof geometry = " << sizeof(Geometry) << endl;
-    cout << "sizeof points   = " << sizeof(Points)   << endl;
-    cout << "sizeof Vector3D = " << sizeof(Vector3D) << endl;
-
-    cout << "n threads = " << paracabs::multi_threading::n_threads_avail() << endl;
-
-
-    Model model;
-    model.read (io);
-
-//    Solver solver (10000, 100);
-//    solver.trace (model);
-//
-//    for (Size i = 0; i < 10; i++)
-//    {
-//        cout << model.geometry.lengths[i] << endl;
-//    }
-
-    // Size1 lengths = model.geometry.get_ray_lengths ();
-//    Size1 lengths = model.geometry.get_ray_lengths_gpu (512, 512);
-
-    // for (Size i = 0; i < 100; i++)
-    // {
-//        cout << model.geometry.lengths[i] << endl;
-        // cout << lengths[i] << endl;
-    // }
+    const Size   n_levels  = (argc > 2) ? std::stoi (argv[2]) : 3;
+
+    cout << "Running test_multigrid..."                              << endl;
+    cout << "-------------------------"                              << endl;
+    cout << "Model name: " << modelName                              << endl;
+    cout << "n levels  = " << n_levels                               << endl;
+    cout << "n threads = " << pc::multi_threading::n_threads_avail() << endl;
+
+    Model model (modelName);
+    model.compute_spectral_discretisation ();
+    model.compute_LTE_level_populations   ();
+    model.compute_inverse_line_widths     ();
+
+    const Size n_created = model.coarsen_grid (n_levels);
+
+    for (Size lvl = 0; lvl <= n_created; lvl++)
+    {
+        cout << "level " << lvl << " : "
+             << model.geometry.points.multiscale.get_n_points (lvl) << " points" << endl;
+    }
+
+    Timer timer("compute level populations (multigrid)");
+    timer.start();
+    const int iterations = model.compute_level_populations_multigrid (true, 100, 1);
+    timer.stop();
+    timer.print();
+
+    cout << "Total number of iterations: " << iterations << endl;
 
     cout << "Done." << endl;
 
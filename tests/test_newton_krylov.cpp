@@ -0,0 +1,52 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include "model/model.hpp"
+#include "tools/timer.hpp"
+
+
+int main (int argc, char **argv)
+{
+    const string modelName      = argv[1];
+    const Size   max_krylov_dim = (argc > 2) ? std::stoi (argv[2]) : 10;
+
+    cout << "Running test_newton_krylov..."                          << endl;
+    cout << "-----------------------------"                          << endl;
+    cout << "Model name: " << modelName                              << endl;
+    cout << "n threads = " << pc::multi_threading::n_threads_avail() << endl;
+
+    // Reference: ALI with Ng acceleration
+    Model model_ali (modelName);
+    model_ali.compute_spectral_discretisation ();
+    model_ali.compute_LTE_level_populations   ();
+    model_ali.compute_inverse_line_widths     ();
+
+    Timer timer_ali("compute level populations (ALI + Ng)");
+    timer_ali.start();
+    const int iterations_ali = model_ali.compute_level_populations (true, 100);
+    timer_ali.stop();
+    timer_ali.print();
+
+    // Jacobian-free Newton-Krylov
+    Model model_jfnk (modelName);
+    model_jfnk.compute_spectral_discretisation ();
+    model_jfnk.compute_LTE_level_populations   ();
+    model_jfnk.compute_inverse_line_widths     ();
+
+    Timer timer_jfnk("compute level populations (JFNK)");
+    timer_jfnk.start();
+    const int iterations_jfnk = model_jfnk.compute_level_populations_newton_krylov (100, max_krylov_dim);
+    timer_jfnk.stop();
+    timer_jfnk.print();
+
+    cout << "ALI + Ng : " << iterations_ali  << " iterations, "
+         << model_ali .n_formal_solutions    << " formal solutions" << endl;
+    cout << "JFNK     : " << iterations_jfnk << " Newton iterations, "
+         << model_jfnk.n_krylov_iterations   << " Krylov iterations, "
+         << model_jfnk.n_formal_solutions    << " formal solutions" << endl;
+
+    cout << "Done." << endl;
+
+    return (0);
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include "gtest/gtest.h"
+#include "model/model.hpp"
+
+
+TEST (parameters, independent_models)
+{
+    Model model_1;
+    Model model_2;
+
+    model_1.parameters.set_npoints (10);
+    model_2.parameters.set_npoints (20);
+
+    EXPECT_EQ (model_1.parameters.npoints(), 10);
+    EXPECT_EQ (model_2.parameters.npoints(), 20);
+
+    // All parts of a model share the parameters of that model
+    EXPECT_EQ (model_1.geometry.points.parameters.npoints(), 10);
+    EXPECT_EQ (model_2.geometry.points.parameters.npoints(), 20);
+    EXPECT_EQ (model_1.lines.parameters.npoints(),           10);
+    EXPECT_EQ (model_2.radiation.frequencies.parameters.npoints(), 20);
+}
+
+
+TEST (parameters, set_once_per_model)
+{
+    Model model;
+
+    model.parameters.set_nrays (12);
+    model.parameters.set_nrays (12);
+
+    EXPECT_THROW (model.geometry.rays.parameters.set_nrays (48), DoubleSetException);
+
+    // Another model can still use another value
+    Model other;
+
+    EXPECT_NO_THROW (other.parameters.set_nrays (48));
+}
+
+
+TEST (parameters, copies_share_storage)
+{
+    Model model;
+
+    Parameters copy = model.parameters;
+
+    copy.set_nfreqs (7);
+
+    EXPECT_EQ (model.parameters.nfreqs(),          7);
+    EXPECT_EQ (model.lines.parameters.nfreqs(),    7);
+}
+
+
+TEST (parameters, copied_models_share_storage)
+{
+    Model model;
+
+    model.parameters.set_npoints (10);
+
+    // Copies of a model (e.g. ensemble variants) describe the same grid
+    Model copy = model;
+
+    EXPECT_EQ (copy.parameters.storage, model.parameters.storage);
+    EXPECT_EQ (copy.geometry.points.parameters.npoints(), 10);
+
+    // hence also the solver settings are shared
+    copy.parameters.set_n_off_diag (2);
+
+    EXPECT_EQ (model.parameters.n_off_diag(),           2);
+    EXPECT_EQ (model.lines.parameters.get_n_off_diag(), 2);
+}
+
+
+TEST (parameters, replaced_parts)
+{
+    Model model;
+
+    // A part created on its own has its own parameters
+    model.lines.lineProducingSpecies.resize (1);
+    model.lines.lineProducingSpecies[0].parameters.set_nquads (3);
+
+    EXPECT_NO_THROW (model.parameters.set_nquads (5));
+
+    // until the model shares its parameters with it
+    model.set_parameters ();
+
+    EXPECT_EQ (model.lines.lineProducingSpecies[0].parameters.nquads(), 5);
+}
+
+
+int main (int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
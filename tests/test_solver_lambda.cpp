@@ -139,7 +139,7 @@ TEST (solver_lambda, lambda)
     const Size length_max = 4*model.parameters.npoints() + 1;
     const Size  width_max =   model.parameters.nfreqs ();
 
-    model.parameters.n_off_diag = model.parameters.npoints();
+    model.parameters.set_n_off_diag (model.parameters.npoints());
 
     Solver solver;
     solver.setup <CoMoving>        (model);